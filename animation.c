@@ -0,0 +1,20 @@
+#include "animation.h"
+
+// Tile offsets are in 8x8 tiles from the start of the sprite image
+
+const struct AnimationFrame thrust_off_frames[] = {
+    { 4, 0 },
+};
+const struct Animation animation_thrust_off = { thrust_off_frames, 1, ANIMATION_ONCE };
+
+const struct AnimationFrame thrust_down_frames[] = {
+    { 7, 8 },
+    { 8, 8 },
+};
+const struct Animation animation_thrust_down = { thrust_down_frames, 2, ANIMATION_LOOP };
+
+const struct AnimationFrame thrust_side_frames[] = {
+    { 5, 8 },
+    { 6, 8 },
+};
+const struct Animation animation_thrust_side = { thrust_side_frames, 2, ANIMATION_LOOP };
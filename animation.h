@@ -0,0 +1,36 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+/*
+ * Sprite animations as const tables in ROM.
+ *
+ * An animation is a list of frames, each a tile offset and how many video
+ * frames to show it. entity_update_all (entity.h) steps every playing
+ * animation once a frame, so a new animation is a new table, not new code.
+ */
+
+// One frame of an animation; a duration of 0 shows the tile until another
+// animation is played
+struct AnimationFrame {
+    unsigned short tile;
+    unsigned short duration;
+};
+
+// What happens after the last frame
+enum AnimationMode {
+    ANIMATION_LOOP, // start over from the first frame
+    ANIMATION_ONCE // keep showing the last frame
+};
+
+struct Animation {
+    const struct AnimationFrame* frames;
+    unsigned char count;
+    unsigned char mode;
+};
+
+// Thrusters: the blank tile while off, and the flames under and beside the lander
+extern const struct Animation animation_thrust_off;
+extern const struct Animation animation_thrust_down;
+extern const struct Animation animation_thrust_side;
+
+#endif
@@ -0,0 +1,22 @@
+// C versions of the assembly routines, used by builds that cannot assemble
+// getIndex.s and updateLanderXvel.s (e.g. the HAL_HOST build)
+
+#include "game.h"
+#include "fixed.h"
+#include "physics.h"
+
+// returns index of bg tile that contains pixel (x, y)
+IWRAM_CODE int getIndex(int x, int y) {
+    // modulo 256
+    x &= 255;
+    y &= 255;
+    // determine row and column, then the tile index
+    return (x >> 3) + (y >> 3) * 32;
+}
+
+// adds thrust (8.8, negative to the left) to lander's x velocity, saturating
+// at FIXED8_MIN and FIXED8_MAX, and decrements remaining fuel (packed BCD)
+void updateLanderXvel(int* xvel, int thrust, int* fuel) {
+    *xvel = fixed8_add_sat(*xvel, thrust);
+    *fuel = bcd_decrement(*fuel);
+}
@@ -0,0 +1,59 @@
+/* assets.h
+ * generated by tools/compress_assets from the png2gba and GBA Tile Editor headers */
+
+#ifndef ASSETS_H
+#define ASSETS_H
+
+// RLE, 32 bytes compressed to 16
+#define LunarLanderTiles_palette_size 32
+extern const unsigned int LunarLanderTiles_palette_compressed[4];
+
+#define LunarLanderTiles_width 88
+#define LunarLanderTiles_height 16
+// LZ77, 704 bytes compressed to 140
+#define LunarLanderTiles_data_size 704
+extern const unsigned int LunarLanderTiles_data_compressed[35];
+
+// RLE, 32 bytes compressed to 16
+#define sprites_palette_size 32
+extern const unsigned int sprites_palette_compressed[4];
+
+#define sprites_width 8
+#define sprites_height 376
+// LZ77, 1504 bytes compressed to 364
+#define sprites_data_size 1504
+extern const unsigned int sprites_data_compressed[91];
+
+#define world_width 128
+#define world_height 64
+// Uncompressed, 16384 bytes
+extern const unsigned short world_map[8192];
+
+#define stars_width 32
+#define stars_height 32
+// RLE, 2048 bytes compressed to 148
+#define stars_size 2048
+extern const unsigned int stars_compressed[37];
+
+#define stars2_width 32
+#define stars2_height 32
+// LZ77, 2048 bytes compressed to 292
+#define stars2_size 2048
+extern const unsigned int stars2_compressed[73];
+
+#define sky_width 32
+#define sky_height 32
+// 2048 byte map of one repeated entry
+#define sky_fill 0x000b
+
+// One bit per tile, set when any pixel of the tile is drawn
+#define LunarLanderTiles_tiles 22
+extern const unsigned int LunarLanderTiles_solid[1];
+
+// Drawn pixels of each tile, 8 rows of a byte each, bit n for pixel n from the left
+extern const unsigned char LunarLanderTiles_mask[176];
+
+// Drawn pixels of each tile, 8 rows of a byte each, bit n for pixel n from the left
+extern const unsigned char sprites_mask[376];
+
+#endif
@@ -0,0 +1,20 @@
+#include "bcd.h"
+
+// Add two packed BCD values
+int bcd_add(int a, int b) {
+    // Add 6 to every digit so a digit sum over 9 carries into the next digit
+    unsigned int t1 = (unsigned int) a + 0x06666666;
+    unsigned int t2 = t1 + (unsigned int) b;
+    // Bits where a carry came in show which digits did not carry out
+    unsigned int no_carry = ~(t2 ^ t1 ^ (unsigned int) b) & 0x11111110;
+    // Take the 6 back out of the digits that did not carry
+    return (int) (t2 - ((no_carry >> 2) | (no_carry >> 3)));
+}
+
+// Subtract 1 from a packed BCD value greater than 0
+int bcd_decrement(int value) {
+    unsigned int result = (unsigned int) value - 1;
+    // Every digit that borrowed went from 0 to 0xf, take 6 off each to make it 9
+    unsigned int borrowed = (((unsigned int) value ^ result) >> 4) & 0x01111111;
+    return (int) (result - borrowed * 6);
+}
@@ -0,0 +1,22 @@
+#ifndef BCD_H
+#define BCD_H
+
+// Packed BCD counters: one decimal digit per 4 bits, so 0x3000 is 3000.
+// Digits come out with shifts and masks, with no division on a CPU that has
+// no hardware divider.
+
+// Add two packed BCD values
+int bcd_add(int a, int b);
+
+// Subtract 1 from a packed BCD value greater than 0
+int bcd_decrement(int value);
+
+// Get digit number place (0 = ones) of a packed BCD value
+#define bcd_digit(value, place) (((value) >> (4 * (place))) & 0xf)
+
+// Value of a packed BCD number of up to four digits; it multiplies, so it is
+// for the host tools rather than the game
+#define bcd_value(value) (bcd_digit(value, 3) * 1000 + bcd_digit(value, 2) * 100 \
+        + bcd_digit(value, 1) * 10 + bcd_digit(value, 0))
+
+#endif
@@ -0,0 +1,67 @@
+@ crt0.s
+@ Cartridge header and start-up code: the BIOS jumps to the start of the ROM
+@ in ARM state once it has checked the header
+
+    .section .crt0, "ax", %progbits
+    .arm
+    .align 2
+    .global _start
+_start:
+    b start
+
+@ Nintendo logo, filled in by gbafix along with the header checksum
+    .fill 156, 1, 0
+@ title, game code and maker code
+    .ascii "LUNAR LANDER"
+    .ascii "LLDE"
+    .ascii "00"
+@ fixed value, main unit code, device type
+    .byte 0x96, 0x00, 0x00
+@ reserved
+    .fill 7, 1, 0
+@ software version, header checksum, reserved
+    .byte 0x00, 0x00
+    .fill 2, 1, 0
+
+start:
+@ IRQ mode stack, then system mode (where the game runs) stack
+    mov r0, #0x12
+    msr cpsr_c, r0
+    ldr sp, =__sp_irq
+    mov r0, #0x1f
+    msr cpsr_c, r0
+    ldr sp, =__sp_usr
+
+@ copy the IWRAM code and the initialised data out of the ROM
+    ldr r0, =__iwram_lma
+    ldr r1, =__iwram_start
+    ldr r2, =__iwram_end
+    bl copy
+    ldr r0, =__data_lma
+    ldr r1, =__data_start
+    ldr r2, =__data_end
+    bl copy
+
+@ clear .bss
+    ldr r1, =__bss_start
+    ldr r2, =__bss_end
+    mov r0, #0
+.clear:
+    cmp r1, r2
+    strlo r0, [r1], #4
+    blo .clear
+
+@ main is Thumb code, so enter it with bx
+    ldr r0, =main
+    mov lr, pc
+    bx r0
+.hang:
+    b .hang
+
+@ copy words from r0 to r1 until r1 reaches r2
+copy:
+    cmp r1, r2
+    ldrlo r3, [r0], #4
+    strlo r3, [r1], #4
+    blo copy
+    bx lr
@@ -0,0 +1,116 @@
+#include "entity.h"
+
+// One past the highest row in use
+int entity_count = 0;
+
+short entity_x[MAX_ENTITIES], entity_y[MAX_ENTITIES];
+unsigned char entity_anchored[MAX_ENTITIES];
+
+const struct Animation* entity_animation[MAX_ENTITIES];
+unsigned char entity_frame[MAX_ENTITIES];
+unsigned short entity_timer[MAX_ENTITIES];
+
+unsigned char entity_sprite[MAX_ENTITIES];
+
+// Free every row; call after sprite_clear, which has taken their sprites
+void entity_clear() {
+    for (int i = 0; i < MAX_ENTITIES; i++) {
+        entity_sprite[i] = ENTITY_FREE;
+    }
+    entity_count = 0;
+}
+
+// Take the lowest free row and a sprite for it, playing animation; returns
+// the row, or -1 when the table or the sprites are full
+int entity_add(int x, int y, int anchored, enum SpriteSize size, int horizontal_flip,
+        const struct Animation* animation, int priority) {
+    int row = 0;
+    while (row < MAX_ENTITIES && entity_sprite[row] != ENTITY_FREE) {
+        row++;
+    }
+    if (row == MAX_ENTITIES) {
+        return -1;
+    }
+
+    struct Sprite* sprite = sprite_init(x, y, size, horizontal_flip, 0, animation->frames[0].tile, priority);
+    if (!sprite) {
+        return -1;
+    }
+    entity_sprite[row] = sprite - sprites;
+    if (row >= entity_count) {
+        entity_count = row + 1;
+    }
+
+    entity_x[row] = x;
+    entity_y[row] = y;
+    entity_anchored[row] = anchored;
+    entity_animation[row] = 0;
+    entity_play(row, animation);
+    return row;
+}
+
+// Give a row and its sprite back
+void entity_remove(int row) {
+    if (entity_sprite[row] == ENTITY_FREE) {
+        return;
+    }
+    sprite_free(&sprites[entity_sprite[row]]);
+    entity_sprite[row] = ENTITY_FREE;
+
+    while (entity_count > 0 && entity_sprite[entity_count - 1] == ENTITY_FREE) {
+        entity_count--;
+    }
+}
+
+// Play an animation from its first frame; playing the one already playing
+// carries on with it
+void entity_play(int row, const struct Animation* animation) {
+    if (animation == entity_animation[row]) {
+        return;
+    }
+    entity_animation[row] = animation;
+    entity_frame[row] = 0;
+    entity_timer[row] = animation->frames[0].duration;
+}
+
+// Step the animation of every row and write them all to the shadow OAM
+IWRAM_CODE void entity_update_all(int anchor_x, int anchor_y) {
+    for (int i = 0; i < entity_count; i++) {
+        int index = entity_sprite[i];
+        if (index == ENTITY_FREE) {
+            continue;
+        }
+
+        // Step the animation when the frame's time is up
+        const struct Animation* animation = entity_animation[i];
+        int frame = entity_frame[i];
+        if (entity_timer[i] && --entity_timer[i] == 0) {
+            if (++frame == animation->count) {
+                frame = animation->mode == ANIMATION_LOOP ? 0 : frame - 1;
+            }
+            entity_frame[i] = frame;
+            entity_timer[i] = animation->frames[frame].duration;
+        }
+        int tile = animation->frames[frame].tile;
+
+        int x = entity_x[i];
+        int y = entity_y[i];
+        if (entity_anchored[i]) {
+            x += anchor_x;
+            y += anchor_y;
+        }
+
+        struct Sprite* sprite = &sprites[index];
+        unsigned short attribute0 = (sprite->attribute0 & 0xff00) | (y & 0xff);
+        unsigned short attribute1 = (sprite->attribute1 & 0xfe00) | (x & 0x1ff);
+        unsigned short attribute2 = (sprite->attribute2 & 0xfc00) | (tile & 0x03ff);
+
+        if (attribute0 != sprite->attribute0 || attribute1 != sprite->attribute1
+                || attribute2 != sprite->attribute2) {
+            sprite->attribute0 = attribute0;
+            sprite->attribute1 = attribute1;
+            sprite->attribute2 = attribute2;
+            sprite_mark_dirty(index);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+/*
+ * Entity table for the simple objects drawn with one sprite each (thrusters
+ * now; debris, pads and hazards later).
+ *
+ * The table is laid out as struct-of-arrays: one array per field, indexed by
+ * the entity's row. entity_update_all walks the rows once a frame, steps
+ * their animation (animation.h) and writes their position and tile straight
+ * into the shadow OAM, so one more object costs one more row rather than
+ * another struct and another copy of the update code.
+ */
+
+#include "hal.h"
+#include "sprite.h"
+#include "animation.h"
+
+// Rows in the table
+#define MAX_ENTITIES 32
+
+// entity_sprite of a row that is not in use
+#define ENTITY_FREE 0xff
+
+// One past the highest row in use
+extern int entity_count;
+
+// Position, relative to the anchor passed to entity_update_all for anchored rows
+extern short entity_x[MAX_ENTITIES], entity_y[MAX_ENTITIES];
+extern unsigned char entity_anchored[MAX_ENTITIES];
+
+// Animation playing, the frame it is on and the video frames left on that
+// frame (0 to hold it)
+extern const struct Animation* entity_animation[MAX_ENTITIES];
+extern unsigned char entity_frame[MAX_ENTITIES];
+extern unsigned short entity_timer[MAX_ENTITIES];
+
+// Index of the row's sprite in the shadow OAM (ENTITY_FREE for a free row)
+extern unsigned char entity_sprite[MAX_ENTITIES];
+
+// Free every row; call after sprite_clear, which has taken their sprites
+void entity_clear();
+
+// Take the lowest free row and a sprite for it, playing animation; returns
+// the row, or -1 when the table or the sprites are full
+int entity_add(int x, int y, int anchored, enum SpriteSize size, int horizontal_flip,
+        const struct Animation* animation, int priority);
+
+// Give a row and its sprite back
+void entity_remove(int row);
+
+// Play an animation from its first frame; playing the one already playing
+// carries on with it
+void entity_play(int row, const struct Animation* animation);
+
+// Step the animation of every row and write them all to the shadow OAM
+IWRAM_CODE void entity_update_all(int anchor_x, int anchor_y);
+
+#endif
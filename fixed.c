@@ -0,0 +1,128 @@
+#include "fixed.h"
+
+// 65536 / n rounded down, for n from 1 (entry 0 is unused)
+const unsigned int fixed_reciprocal[FIXED_RECIPROCALS] = {
+    0x00000, 0x10000, 0x08000, 0x05555, 0x04000, 0x03333, 0x02aaa, 0x02492,
+    0x02000, 0x01c71, 0x01999, 0x01745, 0x01555, 0x013b1, 0x01249, 0x01111,
+    0x01000, 0x00f0f, 0x00e38, 0x00d79, 0x00ccc, 0x00c30, 0x00ba2, 0x00b21,
+    0x00aaa, 0x00a3d, 0x009d8, 0x0097b, 0x00924, 0x008d3, 0x00888, 0x00842,
+    0x00800, 0x007c1, 0x00787, 0x00750, 0x0071c, 0x006eb, 0x006bc, 0x00690,
+    0x00666, 0x0063e, 0x00618, 0x005f4, 0x005d1, 0x005b0, 0x00590, 0x00572,
+    0x00555, 0x00539, 0x0051e, 0x00505, 0x004ec, 0x004d4, 0x004bd, 0x004a7,
+    0x00492, 0x0047d, 0x00469, 0x00456, 0x00444, 0x00432, 0x00421, 0x00410,
+    0x00400, 0x003f0, 0x003e0, 0x003d2, 0x003c3, 0x003b5, 0x003a8, 0x0039b,
+    0x0038e, 0x00381, 0x00375, 0x00369, 0x0035e, 0x00353, 0x00348, 0x0033d,
+    0x00333, 0x00329, 0x0031f, 0x00315, 0x0030c, 0x00303, 0x002fa, 0x002f1,
+    0x002e8, 0x002e0, 0x002d8, 0x002d0, 0x002c8, 0x002c0, 0x002b9, 0x002b1,
+    0x002aa, 0x002a3, 0x0029c, 0x00295, 0x0028f, 0x00288, 0x00282, 0x0027c,
+    0x00276, 0x00270, 0x0026a, 0x00264, 0x0025e, 0x00259, 0x00253, 0x0024e,
+    0x00249, 0x00243, 0x0023e, 0x00239, 0x00234, 0x00230, 0x0022b, 0x00226,
+    0x00222, 0x0021d, 0x00219, 0x00214, 0x00210, 0x0020c, 0x00208, 0x00204,
+    0x00200, 0x001fc, 0x001f8, 0x001f4, 0x001f0, 0x001ec, 0x001e9, 0x001e5,
+    0x001e1, 0x001de, 0x001da, 0x001d7, 0x001d4, 0x001d0, 0x001cd, 0x001ca,
+    0x001c7, 0x001c3, 0x001c0, 0x001bd, 0x001ba, 0x001b7, 0x001b4, 0x001b2,
+    0x001af, 0x001ac, 0x001a9, 0x001a6, 0x001a4, 0x001a1, 0x0019e, 0x0019c,
+    0x00199, 0x00197, 0x00194, 0x00192, 0x0018f, 0x0018d, 0x0018a, 0x00188,
+    0x00186, 0x00183, 0x00181, 0x0017f, 0x0017d, 0x0017a, 0x00178, 0x00176,
+    0x00174, 0x00172, 0x00170, 0x0016e, 0x0016c, 0x0016a, 0x00168, 0x00166,
+    0x00164, 0x00162, 0x00160, 0x0015e, 0x0015c, 0x0015a, 0x00158, 0x00157,
+    0x00155, 0x00153, 0x00151, 0x00150, 0x0014e, 0x0014c, 0x0014a, 0x00149,
+    0x00147, 0x00146, 0x00144, 0x00142, 0x00141, 0x0013f, 0x0013e, 0x0013c,
+    0x0013b, 0x00139, 0x00138, 0x00136, 0x00135, 0x00133, 0x00132, 0x00130,
+    0x0012f, 0x0012e, 0x0012c, 0x0012b, 0x00129, 0x00128, 0x00127, 0x00125,
+    0x00124, 0x00123, 0x00121, 0x00120, 0x0011f, 0x0011e, 0x0011c, 0x0011b,
+    0x0011a, 0x00119, 0x00118, 0x00116, 0x00115, 0x00114, 0x00113, 0x00112,
+    0x00111, 0x0010f, 0x0010e, 0x0010d, 0x0010c, 0x0010b, 0x0010a, 0x00109,
+    0x00108, 0x00107, 0x00106, 0x00105, 0x00104, 0x00103, 0x00102, 0x00101,
+};
+
+// sin(2 pi i / 512) * 4096, rounded
+const short fixed_sin_table[FIXED_ANGLES] = {
+        0,    50,   101,   151,   201,   251,   301,   351,   401,   451,   501,   551,
+      601,   651,   700,   750,   799,   848,   897,   946,   995,  1044,  1092,  1141,
+     1189,  1237,  1285,  1332,  1380,  1427,  1474,  1521,  1567,  1614,  1660,  1706,
+     1751,  1797,  1842,  1886,  1931,  1975,  2019,  2062,  2106,  2149,  2191,  2234,
+     2276,  2317,  2359,  2399,  2440,  2480,  2520,  2559,  2598,  2637,  2675,  2713,
+     2751,  2788,  2824,  2861,  2896,  2932,  2967,  3001,  3035,  3068,  3102,  3134,
+     3166,  3198,  3229,  3260,  3290,  3320,  3349,  3378,  3406,  3433,  3461,  3487,
+     3513,  3539,  3564,  3588,  3612,  3636,  3659,  3681,  3703,  3724,  3745,  3765,
+     3784,  3803,  3822,  3839,  3857,  3873,  3889,  3905,  3920,  3934,  3948,  3961,
+     3973,  3985,  3996,  4007,  4017,  4027,  4036,  4044,  4052,  4059,  4065,  4071,
+     4076,  4081,  4085,  4088,  4091,  4093,  4095,  4096,  4096,  4096,  4095,  4093,
+     4091,  4088,  4085,  4081,  4076,  4071,  4065,  4059,  4052,  4044,  4036,  4027,
+     4017,  4007,  3996,  3985,  3973,  3961,  3948,  3934,  3920,  3905,  3889,  3873,
+     3857,  3839,  3822,  3803,  3784,  3765,  3745,  3724,  3703,  3681,  3659,  3636,
+     3612,  3588,  3564,  3539,  3513,  3487,  3461,  3433,  3406,  3378,  3349,  3320,
+     3290,  3260,  3229,  3198,  3166,  3134,  3102,  3068,  3035,  3001,  2967,  2932,
+     2896,  2861,  2824,  2788,  2751,  2713,  2675,  2637,  2598,  2559,  2520,  2480,
+     2440,  2399,  2359,  2317,  2276,  2234,  2191,  2149,  2106,  2062,  2019,  1975,
+     1931,  1886,  1842,  1797,  1751,  1706,  1660,  1614,  1567,  1521,  1474,  1427,
+     1380,  1332,  1285,  1237,  1189,  1141,  1092,  1044,   995,   946,   897,   848,
+      799,   750,   700,   651,   601,   551,   501,   451,   401,   351,   301,   251,
+      201,   151,   101,    50,     0,   -50,  -101,  -151,  -201,  -251,  -301,  -351,
+     -401,  -451,  -501,  -551,  -601,  -651,  -700,  -750,  -799,  -848,  -897,  -946,
+     -995, -1044, -1092, -1141, -1189, -1237, -1285, -1332, -1380, -1427, -1474, -1521,
+    -1567, -1614, -1660, -1706, -1751, -1797, -1842, -1886, -1931, -1975, -2019, -2062,
+    -2106, -2149, -2191, -2234, -2276, -2317, -2359, -2399, -2440, -2480, -2520, -2559,
+    -2598, -2637, -2675, -2713, -2751, -2788, -2824, -2861, -2896, -2932, -2967, -3001,
+    -3035, -3068, -3102, -3134, -3166, -3198, -3229, -3260, -3290, -3320, -3349, -3378,
+    -3406, -3433, -3461, -3487, -3513, -3539, -3564, -3588, -3612, -3636, -3659, -3681,
+    -3703, -3724, -3745, -3765, -3784, -3803, -3822, -3839, -3857, -3873, -3889, -3905,
+    -3920, -3934, -3948, -3961, -3973, -3985, -3996, -4007, -4017, -4027, -4036, -4044,
+    -4052, -4059, -4065, -4071, -4076, -4081, -4085, -4088, -4091, -4093, -4095, -4096,
+    -4096, -4096, -4095, -4093, -4091, -4088, -4085, -4081, -4076, -4071, -4065, -4059,
+    -4052, -4044, -4036, -4027, -4017, -4007, -3996, -3985, -3973, -3961, -3948, -3934,
+    -3920, -3905, -3889, -3873, -3857, -3839, -3822, -3803, -3784, -3765, -3745, -3724,
+    -3703, -3681, -3659, -3636, -3612, -3588, -3564, -3539, -3513, -3487, -3461, -3433,
+    -3406, -3378, -3349, -3320, -3290, -3260, -3229, -3198, -3166, -3134, -3102, -3068,
+    -3035, -3001, -2967, -2932, -2896, -2861, -2824, -2788, -2751, -2713, -2675, -2637,
+    -2598, -2559, -2520, -2480, -2440, -2399, -2359, -2317, -2276, -2234, -2191, -2149,
+    -2106, -2062, -2019, -1975, -1931, -1886, -1842, -1797, -1751, -1706, -1660, -1614,
+    -1567, -1521, -1474, -1427, -1380, -1332, -1285, -1237, -1189, -1141, -1092, -1044,
+     -995,  -946,  -897,  -848,  -799,  -750,  -700,  -651,  -601,  -551,  -501,  -451,
+     -401,  -351,  -301,  -251,  -201,  -151,  -101,   -50,
+};
+
+// Add two 8.8 values, stopping at FIXED8_MIN and FIXED8_MAX
+int fixed8_add_sat(int a, int b) {
+    int sum = a + b;
+    if (sum > FIXED8_MAX) {
+        return FIXED8_MAX;
+    }
+    if (sum < FIXED8_MIN) {
+        return FIXED8_MIN;
+    }
+    return sum;
+}
+
+// Product of two 8.8 values
+int fixed8_mul(int a, int b) {
+    return (a * b) >> FIXED8_SHIFT;
+}
+
+// Whole pixels to move this frame at an 8.8 velocity, keeping the fraction
+// left over for the next frame
+int fixed8_step(int* fraction, int velocity) {
+    int position = *fraction + velocity;
+    *fraction = position & (FIXED8_ONE - 1);
+    return position >> FIXED8_SHIFT;
+}
+
+// Product of two 16.16 values; in IWRAM as ARM code, where it is one smull
+IWRAM_CODE int fixed16_mul(int a, int b) {
+    return (int) (((long long) a * b) >> FIXED16_SHIFT);
+}
+
+// x / n, rounded down, for n from 1 to FIXED_RECIPROCALS - 1
+int fixed_divide(int x, int n) {
+    return fixed16_mul(x, fixed_reciprocal[n] + 1);
+}
+
+// Sine and cosine of an angle in 1/512 turns, 4.12
+int fixed_sin(int angle) {
+    return fixed_sin_table[angle & (FIXED_ANGLES - 1)];
+}
+
+int fixed_cos(int angle) {
+    return fixed_sin_table[(angle + FIXED_ANGLES / 4) & (FIXED_ANGLES - 1)];
+}
@@ -0,0 +1,80 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+/*
+ * Fixed-point arithmetic for the flight model.
+ *
+ * Values are plain ints; the format is in the name of the variable or
+ * function that holds them:
+ *   8.8    velocities and accelerations, 1/256 pixel per frame. They are kept
+ *          between FIXED8_MIN and FIXED8_MAX by fixed8_add_sat, so a frame's
+ *          move is under 128 pixels and a product of two fits in an int.
+ *   16.16  ratios, from fixed_reciprocal and fixed16_mul.
+ *   4.12   sines and cosines, from fixed_sin and fixed_cos. Angles are in
+ *          1/512 turns, 0 pointing up and increasing clockwise.
+ *
+ * The ARM7TDMI has no divide instruction, so a division is a library call
+ * of a hundred cycles or more. fixed_reciprocal turns division by a small
+ * constant or a move length into a multiply.
+ *
+ * This header is also included by the assembly files, which are put through
+ * the C preprocessor: only the macros are visible there.
+ */
+
+#define FIXED8_SHIFT 8
+#define FIXED8_ONE (1 << FIXED8_SHIFT)
+#define FIXED8_MAX 0x7fff
+#define FIXED8_MIN (-0x8000)
+
+#define FIXED16_SHIFT 16
+#define FIXED16_ONE (1 << FIXED16_SHIFT)
+
+// Whole number as 8.8, and the whole part of an 8.8 value (rounded down)
+#define FIXED8(n) ((n) << FIXED8_SHIFT)
+#define FIXED8_INT(x) ((x) >> FIXED8_SHIFT)
+
+// Entries in the sine table, a whole turn
+#define FIXED_ANGLES 512
+
+// Fraction bits of fixed_sin and fixed_cos
+#define FIXED_SIN_SHIFT 12
+
+// Entries in the reciprocal table
+#define FIXED_RECIPROCALS 256
+
+#ifndef __ASSEMBLER__
+
+#include "hal.h"
+
+// 65536 / n rounded down, for n from 1 to FIXED_RECIPROCALS - 1, in ROM
+extern const unsigned int fixed_reciprocal[FIXED_RECIPROCALS];
+
+// Sine of each angle, 4.12, in ROM
+extern const short fixed_sin_table[FIXED_ANGLES];
+
+// a + b, stopping at FIXED8_MIN and FIXED8_MAX instead of going past them
+int fixed8_add_sat(int a, int b);
+
+// a * b of two 8.8 values, as 8.8
+int fixed8_mul(int a, int b);
+
+// Whole pixels moved this frame at an 8.8 velocity. The part of a pixel left
+// over is kept in *fraction (0 to FIXED8_ONE - 1) and carried into the next
+// frame's move, so slow speeds still move the lander instead of rounding away
+int fixed8_step(int* fraction, int velocity);
+
+// a * b of two 16.16 values, as 16.16 (one smull)
+IWRAM_CODE int fixed16_mul(int a, int b);
+
+// x / n rounded down, for n from 1 to FIXED_RECIPROCALS - 1, with a
+// multiply instead of a division. Exact for 0 <= x < 65536 / n; outside that
+// it can be one off
+int fixed_divide(int x, int n);
+
+// Sine and cosine of an angle in 1/512 turns, 4.12
+int fixed_sin(int angle);
+int fixed_cos(int angle);
+
+#endif
+
+#endif
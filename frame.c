@@ -0,0 +1,31 @@
+#include "hal.h"
+#include "frame.h"
+
+// Number of vblanks since frame_init, counted by the vblank interrupt
+volatile unsigned int frame_count = 0;
+
+// Value of frame_count when frame_wait last returned
+unsigned int frame_last = 0;
+
+// Runs inside the interrupt handler once per vblank
+void frame_vblank() {
+    frame_count++;
+}
+
+// Start counting frames from the vblank interrupt
+void frame_init() {
+    frame_count = 0;
+    frame_last = 0;
+    hal_irq_init(frame_vblank);
+}
+
+// Sleep until the next vblank and return how many frames passed since the previous call
+unsigned int frame_wait() {
+    // Halt the CPU until the interrupt fires instead of polling the scanline counter
+    hal_vblank_intr_wait();
+
+    unsigned int now = frame_count;
+    unsigned int elapsed = now - frame_last;
+    frame_last = now;
+    return elapsed;
+}
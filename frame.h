@@ -0,0 +1,14 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+// Number of vblanks since frame_init, counted by the vblank interrupt
+extern volatile unsigned int frame_count;
+
+// Start counting frames from the vblank interrupt
+void frame_init();
+
+// Sleep until the next vblank and return how many frames passed since the
+// previous call (1 when the game kept up with 60 Hz)
+unsigned int frame_wait();
+
+#endif
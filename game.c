@@ -0,0 +1,528 @@
+#include "assets.h"
+
+#include "game.h"
+#include "entity.h"
+#include "fixed.h"
+#include "scroll.h"
+#include "level.h"
+#include "physics.h"
+#include "terrain.h"
+#include "transfer.h"
+#include "input.h"
+#include "profile.h"
+
+// Set up sprite image and the palette
+void setup_sprite_image() {
+    transfer_decompress(sprite_palette, sprites_palette_compressed);
+    transfer_decompress(sprite_image_memory, sprites_data_compressed);
+}
+
+// Function to set up background for the game
+void setup_background() {
+
+    transfer_decompress(bg_palette, LunarLanderTiles_palette_compressed);
+
+    transfer_decompress(char_block(0), LunarLanderTiles_data_compressed);
+
+    *bg0_control = 0 |    
+        (0 << 2)  |       
+        (0 << 6)  |       
+        (0 << 7)  |       
+        (16 << 8) |       
+        (1 << 13) |       
+        (0 << 14);    
+    *bg1_control = 1 |    
+        (0 << 2)  |       
+        (0 << 6)  |       
+        (0 << 7)  |       
+        (17 << 8) |       
+        (1 << 13) |      
+        (0 << 14);        
+    *bg2_control = 2 |    
+        (0 << 2)  |       
+        (0 << 6)  |       
+        (0 << 7)  |       
+        (18 << 8) |       
+        (1 << 13) |      
+        (0 << 14);        
+    *bg3_control = 3 |    
+        (0 << 2)  |       
+        (0 << 6)  |       
+        (0 << 7)  |       
+        (19 << 8) |       
+        (1 << 13) |      
+        (0 << 14);       
+    // The ground is streamed from world_map into screen_block(16) as the view
+    // scrolls (scroll.h), starting in game_init
+    // Background for stars
+    transfer_decompress(screen_block(17), stars_compressed);
+    // Background for stars2
+    transfer_decompress(screen_block(18), stars2_compressed);
+    // Background for sky, which is one tile repeated over the whole map
+    transfer_fill(screen_block(19), sky_fill | (sky_fill << 16), sky_width * sky_height * 2);
+}
+
+
+// Initializes a character sprite; one of the GAME_SPRITES (game.h)
+void character_init(struct Character* character, int x, int y, int frame) {
+    character->x = x;
+    character->y = y;
+    character->frame = frame;
+    character->sprite = sprite_init(x, y, SIZE_8_8, 0, 0, character->frame, 0);
+}
+
+// Digit offset used to get to where the digit sprite frames start
+#define DIGIT_OFFSET 9
+
+// Initializes the UI which shows the amount of fuel left and score
+void UI_init(struct UI* ui, int x, int y, struct Lander* lander) {
+    ui->x = x;
+    ui->y = y;
+
+    struct Character f, u, e1, l, colon1, s, c, o, r, e2, colon2;
+    // Letter offset used to get where the letter sprite frames start
+    int letter_offset = 18;
+    // Initialize letter character sprites
+    character_init(&f, x + 8, y, letter_offset + 6);
+    character_init(&u, x + 16, y, letter_offset + 21);
+    character_init(&e1, x + 24, y, letter_offset + 5);
+    character_init(&l, x + 32, y, letter_offset + 12);
+    character_init(&colon1, x + 40, y, 46);
+    character_init(&s, x, y + 9, letter_offset + 19);
+    character_init(&c, x + 8, y + 9, letter_offset + 3);
+    character_init(&o, x + 16, y + 9, letter_offset + 15);
+    character_init(&r, x + 24, y + 9, letter_offset + 18);
+    character_init(&e2, x + 32, y + 9, letter_offset + 5);
+    character_init(&colon2, x + 40, y + 9, 46);
+
+    // Digit sprites used to display the amount of fuel left and the score
+    for (int i = 0; i < 4; i++) {
+        character_init(&ui->fuel_digits[i], x + 48 + 8 * i, y, DIGIT_OFFSET);
+    }
+    for (int i = 0; i < 4; i++) {
+        character_init(&ui->score_digits[i], x + 48 + 8 * i, y + 9, DIGIT_OFFSET);
+    }
+    // Make every digit differ from what is shown so the first update sets them all
+    ui->fuel_shown = ~lander->fuel;
+    ui->score_shown = ~lander->score;
+    UI_update(ui, lander);
+};
+
+
+// The flight model the game runs with
+struct FlightModel flight_model = {
+    LANDER_GRAVITY, LANDER_THRUST, LANDER_RCS, LANDING_MAX_XVEL, LANDING_MAX_YVEL
+};
+
+// Put the lander at the start of a game, full of fuel, without its sprite
+void lander_start(struct Lander* lander) {
+    lander->sprite = 0;
+    lander->fuel = LANDER_FUEL;
+    lander->score = 0;
+    lander->width = 8;
+    lander->height = 8;
+    landerReset(lander);
+}
+
+// Initialize lander
+void lander_init(struct Lander* lander) {
+    lander_start(lander);
+    // Initialize sprite of lander and its properties
+    /*
+     * Lander sprite is currently a placeholder and is a 8 by 8 size, if lander sprite is changed to something bigger 
+     * change the SIZE_8_8 value in the third argument and the width and height above to the new sprite size.
+     */
+    // one of the GAME_SPRITES (game.h), so not NULL
+    lander->sprite = sprite_init(lander->x, lander->y, SIZE_8_8, 0, 0, lander->frame, 1);
+    // drawn through an affine matrix so it can turn
+    sprite_affine(lander->sprite, LANDER_AFFINE);
+}
+
+void landerReset(struct Lander* lander) {
+    lander->x = 120;
+    lander->y = 20;
+    lander->xvel = 0;
+    lander->yvel = 0;
+    lander->xfrac = 0;
+    lander->yfrac = 0;
+    lander->gravity = flight_model.gravity;
+    lander->landed = 0;
+    lander->frame = 0;
+    lander_set_angle(lander, 0);
+}
+
+// Thruster sprites: where each sits on the lander, the button that fires it,
+// whether it faces left, and its flame
+const short thrust_xoffset[THRUSTERS] = { 0, -8, 8 };
+const short thrust_yoffset[THRUSTERS] = { 8, 0, 0 };
+const unsigned short thrust_button[THRUSTERS] = { BUTTON_A, BUTTON_RIGHT, BUTTON_LEFT };
+const unsigned char thrust_flip[THRUSTERS] = { 0, 1, 0 };
+const struct Animation* const thrust_flame[THRUSTERS] = {
+    &animation_thrust_down, &animation_thrust_side, &animation_thrust_side
+};
+
+// Add the thrusters to the entity table, anchored to the lander
+void thrust_init(int* thrusters) {
+    for (int i = 0; i < THRUSTERS; i++) {
+        thrusters[i] = entity_add(thrust_xoffset[i], thrust_yoffset[i], 1, SIZE_8_8, thrust_flip[i],
+                &animation_thrust_off, 1);
+    }
+    // the main engine turns with the lander
+    sprite_affine(&sprites[entity_sprite[thrusters[THRUST_VERTICAL]]], LANDER_AFFINE);
+}
+
+
+// Frees the entity rows and sprites of the thrusters
+void thrust_release(int* thrusters) {
+    for (int i = 0; i < THRUSTERS; i++) {
+        entity_remove(thrusters[i]);
+    }
+}
+
+// Checks if the lander is at the bottom of the map, if so return true
+int lander_at_bounds(struct Lander* lander, int* yscroll) {
+    // lowest yscroll value before the bottom of the world scrolls off the screen
+    int bottom = terrain_height - SCREEN_HEIGHT;
+    if (*yscroll >= bottom && lander->y >= 20) {
+	// Change yscroll to the bottom in case it goes under
+	*yscroll = bottom;
+	return 1;
+    // 0 is the highest yscroll value before it transitions to the next copy of the background above
+    } else if (*yscroll <= 0 && lander->y <= 20) {
+	// Change yscroll to 0 in case it goes over
+	*yscroll = 0;
+	return 1;
+    } else {
+	// Set lander y to 20 if false
+	lander->y = 20;
+	return 0;
+    }
+}
+
+// Fires the main engine, pushing the lander along its heading: up when it is
+// upright, and to the right as well when it leans clockwise
+void lander_ascend(struct Lander* lander) {
+    if (!lander->landed && lander->fuel > 0) {
+	lander->xvel = fixed8_add_sat(lander->xvel, (flight_model.thrust * fixed_sin(lander->angle)) >> FIXED_SIN_SHIFT);
+	lander->yvel = fixed8_add_sat(lander->yvel, -((flight_model.thrust * fixed_cos(lander->angle)) >> FIXED_SIN_SHIFT));
+	lander->fuel = bcd_decrement(lander->fuel);
+    }
+}
+
+// Increases or decreases lander x velocity to move it left or right
+void lander_side(struct Lander* lander, int right) {
+    if (!lander->landed && lander->fuel > 0) {
+	// If right is true, increase xvel; If false, decrease xvel
+
+        updateLanderXvel(&(lander->xvel), right ? flight_model.rcs : -flight_model.rcs, &(lander->fuel));
+
+    }
+}
+
+// Turns the lander a step clockwise or anticlockwise, up to LANDER_MAX_TILT
+// either way from upright
+void lander_turn(struct Lander* lander, int clockwise) {
+    if (!lander->landed) {
+        int angle = lander->angle + (clockwise ? LANDER_TURN : -LANDER_TURN);
+        if (angle >= -LANDER_MAX_TILT && angle <= LANDER_MAX_TILT) {
+            lander_set_angle(lander, angle);
+        }
+    }
+}
+
+// Sets the lander's heading and turns the mask its collisions are tested with
+// to match; lander_update turns the sprite
+void lander_set_angle(struct Lander* lander, int angle) {
+    lander->angle = angle;
+
+    // Sample the upright mask the way the hardware draws the sprite: each pixel
+    // of the box, from its middle, goes through the matrix to a pixel of the
+    // tile. Pixels turned out past the 8x8 hitbox are left out
+    short matrix[4];
+    sprite_rotation(angle, matrix);
+    const unsigned char* upright = sprites_mask + lander->frame * 8;
+    for (int y = 0; y < 8; y++) {
+        int row = 0;
+        for (int x = 0; x < 8; x++) {
+            int u = ((matrix[0] * (x - 4) + matrix[1] * (y - 4)) >> 8) + 4;
+            int v = ((matrix[2] * (x - 4) + matrix[3] * (y - 4)) >> 8) + 4;
+            if (u >= 0 && u < 8 && v >= 0 && v < 8 && ((upright[v] >> u) & 1)) {
+                row |= 1 << x;
+            }
+        }
+        lander->mask[y] = row;
+    }
+}
+
+// Drawn pixels of the lander's sprite at its heading, a row per byte
+const unsigned char* lander_mask(struct Lander* lander) {
+    return lander->mask;
+}
+
+// determines if the lander is touching the surface
+// by testing the drawn pixels of its sprite against the ground's
+// returns 2 when standing on both feet on flat ground, 0 when no collision happens, and 1 for any other collision
+IWRAM_CODE int checkCollision(struct Lander* lander, int* xscroll, int* yscroll) {
+    // define lander hitbox
+    int left = *xscroll + lander->x;
+    int right = left + lander->width - 1;
+
+    int top = *yscroll + lander->y;
+    int bottom = top + lander->height - 1;
+
+    // no solid tile within a pixel of the hitbox
+    if (!terrain_overlaps(left - 1, top - 1, right + 1, bottom + 1)) {
+        return 0;
+    }
+
+    const unsigned char* mask = lander_mask(lander);
+
+    // flat under both feet with a pixel to spare each side
+    if (terrain_flat(left, right, bottom) && !terrain_pixels(left, top, mask, lander->height)) {
+        return 2;
+    }
+
+    // ground, ceiling or wall a pixel away from the lander's pixels, or in them
+    if (terrain_pixels(left, top + 1, mask, lander->height) || terrain_pixels(left, top - 1, mask, lander->height)
+            || terrain_pixels(left - 1, top, mask, lander->height) || terrain_pixels(left + 1, top, mask, lander->height)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+// Flies the lander for one frame: moves it by its velocity, stopping at the
+// ground, adds gravity and checks how it touched down. Draws nothing, so the
+// host tools can fly landers with it too
+// returns 2 for a landing, 1 for a crash (including flying into a wall or a
+// ceiling) and 0 while it is still flying
+IWRAM_CODE int lander_fly(struct Lander* lander, int* yscroll, int* xscroll) {
+    // If lander at bottom or top of background, stop scrolling and move lander by changing y value. If false, continue scrolling.
+    int at_bounds = lander_at_bounds(lander, yscroll);
+
+    // Sweep the lander's sprite along this frame's move so a fast lander
+    // stops at the first pixel of ground it reaches instead of passing
+    // through it
+    PROFILE_BEGIN(PROFILE_COLLISION);
+    struct TerrainContact contact;
+    int left = *xscroll + lander->x;
+    int top = *yscroll + lander->y;
+    int dx = fixed8_step(&lander->xfrac, lander->xvel);
+    int dy = fixed8_step(&lander->yfrac, lander->yvel);
+    terrain_sweep(left, top, left + lander->width - 1, top + lander->height - 1,
+            dx, dy, lander_mask(lander), &contact);
+    PROFILE_END(PROFILE_COLLISION);
+
+    if (at_bounds) {
+        lander->y += contact.dy;
+    } else {
+        *yscroll += contact.dy;
+    }
+    // Add gravity to lander y velocity so it falls
+    lander->yvel = fixed8_add_sat(lander->yvel, lander->gravity);
+    // Scroll background left or right depending on the x velocity of the lander
+    *xscroll += contact.dx;
+
+    if (!contact.hit) {
+        return 0;
+    }
+
+    // the lander now rests against the ground, so look at what is under it
+    int collision = checkCollision(lander, xscroll, yscroll);
+
+    int upright = lander->angle >= -LANDING_MAX_TILT && lander->angle <= LANDING_MAX_TILT;
+    lander->landed = 1;
+    if (contact.ny < 0 && collision == 2 && upright && lander->xvel >= 0 && lander->xvel <= flight_model.max_xvel
+            && lander->yvel <= flight_model.max_yvel) {
+        // successful landing on both feet, near upright, with max 1px/frame movement on each axis
+        lander->score = bcd_add(lander->score, LANDING_SCORE);
+        return 2;
+    }
+    // run crash landing sequence here
+    return 1;
+}
+
+// Turns the lander, fires its main engine and its side thrusters for the
+// buttons held (BUTTON_* bits), in the order game_update does
+void lander_control(struct Lander* lander, unsigned short keys) {
+    // Turn the lander with the L and R shoulder buttons
+    if (keys & BUTTON_R) {
+        lander_turn(lander, 1);
+    }
+    if (keys & BUTTON_L) {
+        lander_turn(lander, 0);
+    }
+    // Fire the main engine if A button is pressed
+    if (keys & BUTTON_A) {
+        lander_ascend(lander);
+    }
+    // Move lander left or right if LEFT or RIGHT button is pressed
+    if (keys & BUTTON_RIGHT) {
+        lander_side(lander, 1);
+    }
+    if (keys & BUTTON_LEFT) {
+        lander_side(lander, 0);
+    }
+}
+
+// One frame of the lander as game_update runs it, less the drawing and the
+// reset after touchdown: lander_fly, then lander_control with the buttons
+// held. Host tools fly landers with it; returns what lander_fly returned
+int lander_step(struct Lander* lander, int* yscroll, int* xscroll, unsigned short keys) {
+    int touchdown = lander->landed ? 0 : lander_fly(lander, yscroll, xscroll);
+    lander_control(lander, keys);
+    return touchdown;
+}
+
+// Updates the lander
+IWRAM_CODE void lander_update(struct Lander* lander, int* yscroll , int* xscroll, int* thrusters) {
+    
+    // Update position of lander
+    if (!lander->landed) {
+        lander_fly(lander, yscroll, xscroll);
+    }
+
+    // increment reset timer after landing; the thrusters burn while their
+    // button is held and the lander is still flying
+    if (lander->landed) {
+        lander->landed++;
+    }
+    for (int i = 0; i < THRUSTERS; i++) {
+        int firing = !lander->landed && input_held(thrust_button[i]);
+        entity_play(thrusters[i], firing ? thrust_flame[i] : &animation_thrust_off);
+    }
+
+    if (lander->landed > LANDER_RESET_FRAMES) {
+        landerReset(lander);
+        // Set thrusters to init state, giving their old sprites back first
+        thrust_release(thrusters);
+        thrust_init(thrusters);
+
+        *xscroll = lander->x;
+        *yscroll = lander->y - 20;
+    }
+    
+    
+
+
+    // Keep the main engine's flame under the lander as it turns: its offset
+    // (0, 8) turned to the heading
+    int flame = thrusters[THRUST_VERTICAL];
+    entity_x[flame] = ((-8 * fixed_sin(lander->angle)) >> FIXED_SIN_SHIFT) - 4;
+    entity_y[flame] = ((8 * fixed_cos(lander->angle)) >> FIXED_SIN_SHIFT) - 4;
+
+    // Set lander sprite on the screen position and heading; the lander and the
+    // flame are drawn in boxes twice their size, so they are placed 4 pixels
+    // up and left
+    sprite_rotate(LANDER_AFFINE, lander->angle);
+    sprite_position(lander->sprite, lander->x - 4, lander->y - 4);
+    // Animate the entities and move the anchored ones along with it
+    entity_update_all(lander->x, lander->y);
+}
+
+
+// Points four digit sprites at the digits of a packed BCD value,
+// only touching the sprites whose digit differs from the shown value
+void UI_show_number(struct Character* digits, int value, int shown) {
+    int changed = value ^ shown;
+    for (int i = 0; i < 4; i++) {
+        int place = 3 - i;
+        if (bcd_digit(changed, place)) {
+            digits[i].frame = DIGIT_OFFSET + bcd_digit(value, place);
+            sprite_set_offset(digits[i].sprite, digits[i].frame);
+        }
+    }
+}
+
+// Updates the UI by changing the tile offsets of the digit character sprites
+IWRAM_CODE void UI_update(struct UI* ui, struct Lander* lander) {
+    // Change frames for the digit character sprites based on score and amount of fuel left
+    if (lander->fuel != ui->fuel_shown) {
+        UI_show_number(ui->fuel_digits, lander->fuel, ui->fuel_shown);
+        ui->fuel_shown = lander->fuel;
+    }
+    if (lander->score != ui->score_shown) {
+        UI_show_number(ui->score_digits, lander->score, ui->score_shown);
+        ui->score_shown = lander->score;
+    }
+}
+
+
+_Static_assert(GAME_SPRITES <= NUM_SPRITES, "the lander, thrusters and UI must fit in OAM");
+
+// Set up the sprites, lander, thrusters and UI for a new game
+void game_init(struct Game* game) {
+    // Every sprite is free again, so the GAME_SPRITES taken below all succeed
+    sprite_clear();
+    entity_clear();
+    input_reset();
+
+    // Initialize lander
+    lander_init(&game->lander);
+
+    //Initialize Thruster
+    thrust_init(game->thrusters);
+
+    // Initialize UI
+    UI_init(&game->ui, 1, 1, &game->lander);
+
+    // Set initial scroll to lander x and y position
+    game->xscroll = game->lander.x;
+    game->yscroll = game->lander.y - 20;
+
+    // The first level is the world map; the ones after it are generated
+    game->level = 1;
+    game->level_seed = 1;
+    terrain_init(world_map, world_width, world_height);
+    // Fill the ground layer around the first view
+    scroll_load(world_map, world_width, world_height);
+    scroll_update(game->xscroll, game->yscroll);
+}
+
+// Generate the next level and start streaming it; the screen block is
+// refilled in the next vblank
+void game_next_level(struct Game* game) {
+    level_generate(game->level_seed, level_is_cavern(game->level + 1));
+    level_random(&game->level_seed);
+    game->level++;
+    scroll_load(level_map, LEVEL_WIDTH, LEVEL_HEIGHT);
+}
+
+// Run the game logic for one frame
+void game_update(struct Game* game) {
+    // Update UI
+    PROFILE_BEGIN(PROFILE_UI);
+    UI_update(&game->ui, &game->lander);
+    PROFILE_END(PROFILE_UI);
+    // Update the lander and thrust
+    // The lander is reset this frame when it has been down long enough
+    int resetting = game->lander.landed >= LANDER_RESET_FRAMES;
+    PROFILE_BEGIN(PROFILE_LANDER);
+    lander_update(&game->lander, &game->yscroll, &game->xscroll, game->thrusters);
+    PROFILE_END(PROFILE_LANDER);
+    // Fly the reset lander over a new level
+    if (resetting) {
+        game_next_level(game);
+    }
+    // Turn, thrust and fire the side thrusters with the buttons held
+    lander_control(&game->lander, input_keys);
+}
+
+// Push the frame to the screen; call during vblank
+void game_draw(struct Game* game) {
+    // Copy the ground newly scrolled into view
+    PROFILE_BEGIN(PROFILE_SCROLL);
+    scroll_update(game->xscroll, game->yscroll);
+    PROFILE_END(PROFILE_SCROLL);
+    // Scroll the backgrounds
+    *bg0_x_scroll = game->xscroll;
+    *bg0_y_scroll = game->yscroll;
+    *bg1_x_scroll = fixed_divide(game->xscroll, 7);
+    *bg1_y_scroll = fixed_divide(game->yscroll, 7);
+    *bg2_x_scroll = fixed_divide(game->xscroll, 15);
+    *bg2_y_scroll = fixed_divide(game->yscroll, 15);
+    // Update sprites on screen
+    PROFILE_BEGIN(PROFILE_OAM);
+    sprite_update_all();
+    PROFILE_END(PROFILE_OAM);
+}
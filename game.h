@@ -0,0 +1,117 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "hal.h"
+#include "sprite.h"
+#include "bcd.h"
+
+#define PALETTE_SIZE 256
+
+// Struct for the lander
+struct Lander {
+    struct Sprite* sprite;
+    int x, y;
+    int xvel; // 8.8 (fixed.h), pixels per frame
+    int yvel;
+    int xfrac, yfrac; // 1/256 pixels moved but not yet shown
+    int gravity;
+    int landed;
+    int fuel; // packed BCD
+    int score; // packed BCD
+    int frame;
+    int border;
+    int width, height; // size of the sprite in pixels
+    int angle; // heading in 1/512 turns (fixed.h), clockwise from upright
+    unsigned char mask[8]; // drawn pixels of the sprite turned to angle, a row per byte
+};
+
+// Affine matrix the lander and its main engine flame are drawn with
+#define LANDER_AFFINE 0
+
+// Thrusters, each one a row of the entity table (entity.h)
+enum Thruster {
+    THRUST_VERTICAL, // under the lander, fired with A
+    THRUST_LEFT, // on the left side, fired with RIGHT
+    THRUST_RIGHT, // on the right side, fired with LEFT
+    THRUSTERS
+};
+
+// Sprites game_init takes for the lander, its thrusters and the UI's 11
+// letters and 8 digits. It starts from sprite_clear, so with this many fitting
+// in OAM none of their sprite_init calls can return NULL; sprites added on top
+// of these have to check
+#define GAME_SPRITES (1 + THRUSTERS + 11 + 8)
+
+// Struct for characters
+struct Character {
+    struct Sprite* sprite;
+    int x, y;
+    int frame;
+};
+
+// Struct for the UI
+struct UI {
+    int x, y;
+    // Digit sprites, most significant digit first
+    struct Character fuel_digits[4];
+    struct Character score_digits[4];
+    // Fuel and score the digit sprites currently show
+    int fuel_shown, score_shown;
+};
+
+// Everything that makes up one running game
+struct Game {
+    struct Lander lander;
+    int thrusters[THRUSTERS]; // entity rows
+    struct UI ui;
+    int xscroll, yscroll;
+    int level; // levels started, counting the first
+    unsigned int level_seed; // seed of the next generated level
+};
+
+void setup_sprite_image();
+void setup_background();
+
+void character_init(struct Character* character, int x, int y, int frame);
+void UI_init(struct UI* ui, int x, int y, struct Lander* lander);
+void UI_show_number(struct Character* digits, int value, int shown);
+IWRAM_CODE void UI_update(struct UI* ui, struct Lander* lander);
+
+void lander_start(struct Lander* lander);
+void lander_init(struct Lander* lander);
+void landerReset(struct Lander* lander);
+void thrust_init(int* thrusters);
+void thrust_release(int* thrusters);
+int lander_at_bounds(struct Lander* lander, int* yscroll);
+void lander_ascend(struct Lander* lander);
+void lander_side(struct Lander* lander, int right);
+void lander_turn(struct Lander* lander, int clockwise);
+void lander_set_angle(struct Lander* lander, int angle);
+const unsigned char* lander_mask(struct Lander* lander);
+IWRAM_CODE int checkCollision(struct Lander* lander, int* xscroll, int* yscroll);
+IWRAM_CODE int lander_fly(struct Lander* lander, int* yscroll, int* xscroll);
+void lander_control(struct Lander* lander, unsigned short keys);
+int lander_step(struct Lander* lander, int* yscroll, int* xscroll, unsigned short keys);
+IWRAM_CODE void lander_update(struct Lander* lander, int* yscroll , int* xscroll, int* thrusters);
+
+// asm function (ARM code in IWRAM)
+// returns index of bg tile that contains pixel (x, y)
+IWRAM_CODE int getIndex(int x, int y);
+
+// adds thrust (8.8, negative to the left) to lander's x velocity, saturating
+// at FIXED8_MIN and FIXED8_MAX, and decrements remaining fuel (packed BCD)
+void updateLanderXvel(int* xvel, int thrust, int* fuel);
+
+// Set up the sprites, lander, thrusters and UI for a new game
+void game_init(struct Game* game);
+
+// Generate the next level and start streaming it
+void game_next_level(struct Game* game);
+
+// Run the game logic for one frame
+void game_update(struct Game* game);
+
+// Push the frame to the screen; call during vblank
+void game_draw(struct Game* game);
+
+#endif
@@ -1,6 +1,11 @@
 @ getIndex.s
+@ ARM code in IWRAM, like the IWRAM_CODE functions in C
 
-.global getIndex
+    .section .iwram, "ax", %progbits
+    .arm
+    .align 2
+    .global getIndex
+    .type getIndex, %function
 getIndex:
     @ modulo 256
     and r0, r0, #255
@@ -16,4 +21,5 @@ getIndex:
 
     add r0, r0, r1
 
-    mov pc, lr
+    @ bx returns to Thumb callers as well as ARM ones
+    bx lr
@@ -0,0 +1,325 @@
+#include "hal.h"
+
+#ifdef HAL_HOST
+#include <string.h>
+#include <time.h>
+
+// Memory regions that stand in for the GBA hardware on a host build
+unsigned char hal_io[IO_SIZE] __attribute__((aligned(4)));
+unsigned char hal_palette[PALETTE_RAM_SIZE] __attribute__((aligned(4)));
+unsigned char hal_vram[VRAM_SIZE] __attribute__((aligned(4)));
+unsigned char hal_oam[OAM_SIZE] __attribute__((aligned(4)));
+#endif
+
+// Pointers to registers of the 4 tile layers
+volatile unsigned short* bg0_control = (volatile unsigned short*) (IO_BASE + 0x008);
+volatile unsigned short* bg1_control = (volatile unsigned short*) (IO_BASE + 0x00a);
+volatile unsigned short* bg2_control = (volatile unsigned short*) (IO_BASE + 0x00c);
+volatile unsigned short* bg3_control = (volatile unsigned short*) (IO_BASE + 0x00e);
+
+// Pointers to scrolling registers for the background
+volatile short* bg0_x_scroll = (volatile short*) (IO_BASE + 0x010);
+volatile short* bg0_y_scroll = (volatile short*) (IO_BASE + 0x012);
+volatile short* bg1_x_scroll = (volatile short*) (IO_BASE + 0x014);
+volatile short* bg1_y_scroll = (volatile short*) (IO_BASE + 0x016);
+volatile short* bg2_x_scroll = (volatile short*) (IO_BASE + 0x018);
+volatile short* bg2_y_scroll = (volatile short*) (IO_BASE + 0x01a);
+volatile short* bg3_x_scroll = (volatile short*) (IO_BASE + 0x01c);
+volatile short* bg3_y_scroll = (volatile short*) (IO_BASE + 0x01e);
+
+// Pointers to registers used by program
+volatile unsigned int* display_control = (volatile unsigned int*) (IO_BASE + 0x000);
+volatile unsigned short* sprite_attribute_memory = (volatile unsigned short*) OAM_BASE;
+volatile unsigned short* sprite_image_memory = (volatile unsigned short*) (VRAM_BASE + 0x10000);
+volatile unsigned short* bg_palette = (volatile unsigned short*) PALETTE_BASE;
+volatile unsigned short* sprite_palette = (volatile unsigned short*) (PALETTE_BASE + 0x200);
+volatile unsigned short* buttons = (volatile unsigned short*) (IO_BASE + 0x130);
+volatile unsigned short* scanline_counter = (volatile unsigned short*) (IO_BASE + 0x006);
+volatile unsigned short* display_status = (volatile unsigned short*) (IO_BASE + 0x004);
+
+// Pointers to the counter and control registers of timers 0 and 1
+volatile unsigned short* timer0_data = (volatile unsigned short*) (IO_BASE + 0x100);
+volatile unsigned short* timer0_control = (volatile unsigned short*) (IO_BASE + 0x102);
+volatile unsigned short* timer1_data = (volatile unsigned short*) (IO_BASE + 0x104);
+volatile unsigned short* timer1_control = (volatile unsigned short*) (IO_BASE + 0x106);
+
+// Pointers to the interrupt enable, request flags and master enable registers
+volatile unsigned short* irq_enable = (volatile unsigned short*) (IO_BASE + 0x200);
+volatile unsigned short* irq_flags = (volatile unsigned short*) (IO_BASE + 0x202);
+volatile unsigned short* irq_master = (volatile unsigned short*) (IO_BASE + 0x208);
+
+// Pointers to location of DMA source and location
+volatile unsigned int* dma_source = (volatile unsigned int*) (IO_BASE + 0x0d4);
+volatile unsigned int* dma_destination = (volatile unsigned int*) (IO_BASE + 0x0d8);
+// Pointer to DMA count
+volatile unsigned int* dma_count = (volatile unsigned int*) (IO_BASE + 0x0dc);
+
+// Return pointer to one of 4 character blocks
+volatile unsigned short* char_block(unsigned long block) {
+    return (volatile unsigned short*) (VRAM_BASE + (block * 0x4000));
+}
+
+// Return pointer to one of 32 screen blocks
+volatile unsigned short* screen_block(unsigned long block) {
+    return (volatile unsigned short*) (VRAM_BASE + (block * 0x800));
+}
+
+#ifndef HAL_HOST
+// The BIOS jumps to the handler stored here, and VBlankIntrWait watches these flags
+#define bios_irq_handler (*(void (**)()) 0x3007ffc)
+#define bios_irq_flags (*(volatile unsigned short*) 0x3007ff8)
+#endif
+
+// Function called on every vblank interrupt
+void (*hal_vblank_handler)() = 0;
+
+// Interrupt handler: run the handler of each raised interrupt, then acknowledge it.
+// The BIOS enters it in ARM state, so it must not be compiled as Thumb
+IWRAM_CODE void hal_irq_handler() {
+    unsigned short raised = *irq_flags & *irq_enable;
+
+    if ((raised & IRQ_VBLANK) && hal_vblank_handler) {
+        hal_vblank_handler();
+    }
+
+#ifdef HAL_HOST
+    *irq_flags &= ~raised;
+#else
+    // Writing a 1 clears the request flag
+    *irq_flags = raised;
+    bios_irq_flags |= raised;
+#endif
+}
+
+// Install the interrupt handler and enable the vblank interrupt
+void hal_irq_init(void (*vblank_handler)()) {
+    *irq_master = 0;
+    hal_vblank_handler = vblank_handler;
+#ifndef HAL_HOST
+    bios_irq_handler = hal_irq_handler;
+#endif
+    *display_status |= DISPSTAT_VBLANK_IRQ;
+    *irq_enable |= IRQ_VBLANK;
+    *irq_master = 1;
+}
+
+#ifdef HAL_HOST
+
+// Reset all emulated memory to its power-on state (no buttons held)
+void hal_host_init() {
+    memset(hal_io, 0, sizeof(hal_io));
+    memset(hal_palette, 0, sizeof(hal_palette));
+    memset(hal_vram, 0, sizeof(hal_vram));
+    memset(hal_oam, 0, sizeof(hal_oam));
+    *buttons = BUTTON_MASK;
+}
+
+// Set which buttons are held down, using the BUTTON_* bits
+void hal_host_set_buttons(unsigned short held) {
+    // The key input register reads 0 for a held button
+    *buttons = ~held & BUTTON_MASK;
+}
+
+// Do the transfer DMA 3 would do, including the address step modes
+void hal_dma3(volatile void* dest, const volatile void* source, unsigned int control) {
+    int unit = (control & DMA_32) ? 4 : 2;
+    int count = control & 0xffff;
+    int dest_step = unit, source_step = unit;
+    volatile unsigned char* d = (volatile unsigned char*) dest;
+    const volatile unsigned char* s = (const volatile unsigned char*) source;
+
+    if (count == 0) {
+        count = 0x10000;
+    }
+    switch ((control >> 21) & 3) {
+        case 1: dest_step = -unit; break;
+        case 2: dest_step = 0; break;
+    }
+    switch ((control >> 23) & 3) {
+        case 1: source_step = -unit; break;
+        case 2: source_step = 0; break;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (unit == 4) {
+            *(volatile unsigned int*) d = *(const volatile unsigned int*) s;
+        } else {
+            *(volatile unsigned short*) d = *(const volatile unsigned short*) s;
+        }
+        d += dest_step;
+        s += source_step;
+    }
+}
+
+// Do what the BIOS CpuFastSet call does
+void hal_cpu_fast_set(const volatile void* source, volatile void* dest, unsigned int control) {
+    const volatile unsigned int* s = (const volatile unsigned int*) source;
+    volatile unsigned int* d = (volatile unsigned int*) dest;
+    // The BIOS rounds the count up to a whole block of 8 words
+    int words = ((control & 0x1fffff) + 7) & ~7;
+    unsigned int fill = *s;
+
+    for (int i = 0; i < words; i++) {
+        d[i] = (control & CPU_FAST_SET_FILL) ? fill : s[i];
+    }
+}
+
+// Do what the BIOS LZ77UnCompVram call does
+void hal_lz77_uncomp_vram(const void* source, volatile void* dest) {
+    const unsigned char* s = (const unsigned char*) source;
+    volatile unsigned char* d = (volatile unsigned char*) dest;
+    int size = s[1] | (s[2] << 8) | (s[3] << 16);
+    int out = 0;
+
+    s += 4;
+    while (out < size) {
+        unsigned char flags = *s++;
+        for (int bit = 0; bit < 8 && out < size; bit++, flags <<= 1) {
+            if (flags & 0x80) {
+                // Copy 3 to 18 bytes from 1 to 4096 bytes back
+                int length = (s[0] >> 4) + 3;
+                int distance = (((s[0] & 0xf) << 8) | s[1]) + 1;
+                s += 2;
+                for (int i = 0; i < length && out < size; i++, out++) {
+                    d[out] = d[out - distance];
+                }
+            } else {
+                d[out++] = *s++;
+            }
+        }
+    }
+}
+
+// Do what the BIOS RLUnCompVram call does
+void hal_rl_uncomp_vram(const void* source, volatile void* dest) {
+    const unsigned char* s = (const unsigned char*) source;
+    volatile unsigned char* d = (volatile unsigned char*) dest;
+    int size = s[1] | (s[2] << 8) | (s[3] << 16);
+    int out = 0;
+
+    s += 4;
+    while (out < size) {
+        unsigned char flag = *s++;
+        if (flag & 0x80) {
+            // A run of 3 to 130 copies of one byte
+            int length = (flag & 0x7f) + 3;
+            for (int i = 0; i < length && out < size; i++) {
+                d[out++] = *s;
+            }
+            s++;
+        } else {
+            // 1 to 128 bytes stored as they are
+            int length = (flag & 0x7f) + 1;
+            for (int i = 0; i < length && out < size; i++) {
+                d[out++] = *s++;
+            }
+        }
+    }
+}
+
+// Host time when hal_cycles_start was called
+struct timespec hal_cycles_epoch;
+
+// Start the cycle counter
+void hal_cycles_start() {
+    clock_gettime(CLOCK_MONOTONIC, &hal_cycles_epoch);
+}
+
+// Host time since hal_cycles_start, scaled to 16.78 MHz GBA cycles
+unsigned int hal_cycles() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long ns = (now.tv_sec - hal_cycles_epoch.tv_sec) * 1000000000LL + (now.tv_nsec - hal_cycles_epoch.tv_nsec);
+    return (unsigned int) (ns * 16777216 / 1000000000);
+}
+
+// Simulated interrupt source: start a vblank and raise its interrupt
+void hal_host_raise_vblank() {
+    *scanline_counter = SCREEN_HEIGHT;
+    if (*display_status & DISPSTAT_VBLANK_IRQ) {
+        *irq_flags |= IRQ_VBLANK;
+    }
+    if (*irq_master && (*irq_flags & *irq_enable)) {
+        hal_irq_handler();
+    }
+}
+
+// There is no display on the host, so the next vblank starts right away
+void hal_vblank_intr_wait() {
+    hal_host_raise_vblank();
+}
+
+#else
+
+// Use DMA to copy data
+void hal_dma3(volatile void* dest, const volatile void* source, unsigned int control) {
+    *dma_source = (unsigned int) source;
+    *dma_destination = (unsigned int) dest;
+    *dma_count = control;
+}
+
+// BIOS CpuFastSet
+void hal_cpu_fast_set(const volatile void* source, volatile void* dest, unsigned int control) {
+    register const volatile void* r0 asm("r0") = source;
+    register volatile void* r1 asm("r1") = dest;
+    register unsigned int r2 asm("r2") = control;
+#ifdef __thumb__
+    asm volatile("swi 0x0c" : "+r"(r0), "+r"(r1), "+r"(r2) :: "r3", "memory");
+#else
+    asm volatile("swi 0x0c0000" : "+r"(r0), "+r"(r1), "+r"(r2) :: "r3", "memory");
+#endif
+}
+
+// BIOS LZ77UnCompVram
+void hal_lz77_uncomp_vram(const void* source, volatile void* dest) {
+    register const void* r0 asm("r0") = source;
+    register volatile void* r1 asm("r1") = dest;
+#ifdef __thumb__
+    asm volatile("swi 0x12" : "+r"(r0), "+r"(r1) :: "r2", "r3", "memory");
+#else
+    asm volatile("swi 0x120000" : "+r"(r0), "+r"(r1) :: "r2", "r3", "memory");
+#endif
+}
+
+// BIOS RLUnCompVram
+void hal_rl_uncomp_vram(const void* source, volatile void* dest) {
+    register const void* r0 asm("r0") = source;
+    register volatile void* r1 asm("r1") = dest;
+#ifdef __thumb__
+    asm volatile("swi 0x15" : "+r"(r0), "+r"(r1) :: "r2", "r3", "memory");
+#else
+    asm volatile("swi 0x150000" : "+r"(r0), "+r"(r1) :: "r2", "r3", "memory");
+#endif
+}
+
+// Start the cycle counter: timer 0 counts every cycle and timer 1 counts its overflows
+void hal_cycles_start() {
+    *timer0_control = 0;
+    *timer1_control = 0;
+    *timer0_data = 0;
+    *timer1_data = 0;
+    *timer1_control = TIMER_ENABLE | TIMER_CASCADE;
+    *timer0_control = TIMER_ENABLE;
+}
+
+// CPU cycles since hal_cycles_start
+unsigned int hal_cycles() {
+    unsigned int high, low;
+    // Read the high half again if timer 0 overflowed between the two reads
+    do {
+        high = *timer1_data;
+        low = *timer0_data;
+    } while (high != *timer1_data);
+    return (high << 16) | low;
+}
+
+// Sleep until the next vblank interrupt has been handled (BIOS VBlankIntrWait)
+void hal_vblank_intr_wait() {
+#ifdef __thumb__
+    asm volatile("swi 0x05" ::: "r0", "r1", "r2", "r3", "memory");
+#else
+    asm volatile("swi 0x050000" ::: "r0", "r1", "r2", "r3", "memory");
+#endif
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef HAL_H
+#define HAL_H
+
+/*
+ * Hardware abstraction layer
+ *
+ * The game only touches the GBA through the four memory regions below, so the
+ * backend is picked at build time by where those regions live:
+ *   - default:  the real MMIO/VRAM/OAM addresses of the GBA
+ *   - HAL_HOST: plain arrays owned by hal.c, so the game runs headless on a PC
+ */
+
+#define IO_SIZE 0x400
+#define PALETTE_RAM_SIZE 0x400
+#define VRAM_SIZE 0x18000
+#define OAM_SIZE 0x400
+
+#ifdef HAL_HOST
+extern unsigned char hal_io[IO_SIZE];
+extern unsigned char hal_palette[PALETTE_RAM_SIZE];
+extern unsigned char hal_vram[VRAM_SIZE];
+extern unsigned char hal_oam[OAM_SIZE];
+
+#define IO_BASE ((volatile unsigned char*) hal_io)
+#define PALETTE_BASE ((volatile unsigned char*) hal_palette)
+#define VRAM_BASE ((volatile unsigned char*) hal_vram)
+#define OAM_BASE ((volatile unsigned char*) hal_oam)
+#else
+#define IO_BASE ((volatile unsigned char*) 0x4000000)
+#define PALETTE_BASE ((volatile unsigned char*) 0x5000000)
+#define VRAM_BASE ((volatile unsigned char*) 0x6000000)
+#define OAM_BASE ((volatile unsigned char*) 0x7000000)
+#endif
+
+// Marks a function that runs every frame. On the GBA it is compiled as 32-bit
+// ARM code and crt0.s copies it to IWRAM, where the 32-bit bus has no wait
+// states; the rest of the game is Thumb code in ROM. Put it on the declaration
+// too, so callers use a long call (IWRAM is out of reach of a plain bl).
+#ifdef HAL_HOST
+#define IWRAM_CODE
+#else
+#define IWRAM_CODE __attribute__((section(".iwram"), target("arm"), long_call))
+#endif
+
+// Marks a large zero-initialised table that goes in the 256K of EWRAM rather
+// than the 32K of IWRAM. EWRAM is a 16-bit bus with 2 wait states, so keep it
+// for data read a few times per frame, not in inner loops.
+#ifdef HAL_HOST
+#define EWRAM_DATA
+#else
+#define EWRAM_DATA __attribute__((section(".ewram")))
+#endif
+
+#define SCREEN_WIDTH 240
+#define SCREEN_HEIGHT 160
+
+#define MODE0 0x00
+#define BG0_ENABLE 0x100
+#define BG1_ENABLE 0x200
+#define BG2_ENABLE 0x400
+#define BG3_ENABLE 0x800
+
+#define SPRITE_MAP_2D 0x0
+#define SPRITE_MAP_1D 0x40
+#define SPRITE_ENABLE 0x1000
+
+// Pointers to registers of the 4 tile layers
+extern volatile unsigned short* bg0_control;
+extern volatile unsigned short* bg1_control;
+extern volatile unsigned short* bg2_control;
+extern volatile unsigned short* bg3_control;
+
+// Pointers to scrolling registers for the background
+extern volatile short* bg0_x_scroll;
+extern volatile short* bg0_y_scroll;
+extern volatile short* bg1_x_scroll;
+extern volatile short* bg1_y_scroll;
+extern volatile short* bg2_x_scroll;
+extern volatile short* bg2_y_scroll;
+extern volatile short* bg3_x_scroll;
+extern volatile short* bg3_y_scroll;
+
+// Pointers to registers used by program
+extern volatile unsigned int* display_control;
+extern volatile unsigned short* sprite_attribute_memory;
+extern volatile unsigned short* sprite_image_memory;
+extern volatile unsigned short* bg_palette;
+extern volatile unsigned short* sprite_palette;
+extern volatile unsigned short* buttons;
+extern volatile unsigned short* scanline_counter;
+extern volatile unsigned short* display_status;
+
+// Pointers to the counter and control registers of timers 0 and 1
+extern volatile unsigned short* timer0_data;
+extern volatile unsigned short* timer0_control;
+extern volatile unsigned short* timer1_data;
+extern volatile unsigned short* timer1_control;
+
+// Pointers to the interrupt enable, request flags and master enable registers
+extern volatile unsigned short* irq_enable;
+extern volatile unsigned short* irq_flags;
+extern volatile unsigned short* irq_master;
+
+// Bit positions for each button used by program
+#define BUTTON_A (1 << 0)
+#define BUTTON_RIGHT (1 << 4)
+#define BUTTON_LEFT (1 << 5)
+// Buttons used for testing background scroll
+#define BUTTON_UP (1 << 6)
+#define BUTTON_DOWN (1 << 7)
+// Shoulder buttons, turning the lander
+#define BUTTON_R (1 << 8)
+#define BUTTON_L (1 << 9)
+
+// All 10 key bits of the key input register (released = 1)
+#define BUTTON_MASK 0x03ff
+
+// Flags for enabling DMA and sizes to transfer
+#define DMA_ENABLE 0x80000000
+#define DMA_16 0x00000000
+#define DMA_32 0x04000000
+// Flag to read the same source address for every unit (for fills)
+#define DMA_SOURCE_FIXED 0x01000000
+
+// Flag for CpuFastSet to write the first source word to every destination word
+#define CPU_FAST_SET_FILL (1 << 24)
+
+// Timer control bits
+#define TIMER_ENABLE 0x80
+#define TIMER_CASCADE 0x04
+
+// CPU cycles in one frame (228 lines of 1232 cycles)
+#define CYCLES_PER_FRAME 280896
+
+// Interrupt bits used by program
+#define IRQ_VBLANK (1 << 0)
+// Display status bit that makes the display raise the vblank interrupt
+#define DISPSTAT_VBLANK_IRQ (1 << 3)
+
+// Return pointer to one of 4 character blocks
+volatile unsigned short* char_block(unsigned long block);
+
+// Return pointer to one of 32 screen blocks
+volatile unsigned short* screen_block(unsigned long block);
+
+// Start a DMA 3 transfer; control is the unit count ORed with the DMA flags
+void hal_dma3(volatile void* dest, const volatile void* source, unsigned int control);
+
+// BIOS CpuFastSet: copy (or fill with CPU_FAST_SET_FILL) control & 0x1fffff words
+// in blocks of 8; both addresses must be word aligned
+void hal_cpu_fast_set(const volatile void* source, volatile void* dest, unsigned int control);
+
+// BIOS LZ77UnCompVram and RLUnCompVram: decompress data in the GBA BIOS
+// format straight into VRAM (or palette RAM), writing 16 bits at a time
+void hal_lz77_uncomp_vram(const void* source, volatile void* dest);
+void hal_rl_uncomp_vram(const void* source, volatile void* dest);
+
+// Start the cycle counter made of timers 0 and 1 cascaded
+void hal_cycles_start();
+
+// CPU cycles since hal_cycles_start (on the host, host time scaled to GBA cycles)
+unsigned int hal_cycles();
+
+// Install the interrupt handler and enable the vblank interrupt, which then
+// calls vblank_handler once per frame
+void hal_irq_init(void (*vblank_handler)());
+
+// Sleep until the next vblank interrupt has been handled
+void hal_vblank_intr_wait();
+
+#ifdef HAL_HOST
+// Reset all emulated memory to its power-on state (no buttons held)
+void hal_host_init();
+
+// Set which buttons are held down, using the BUTTON_* bits
+void hal_host_set_buttons(unsigned short held);
+
+// Simulated interrupt source: start a vblank and raise its interrupt the way
+// the display hardware would
+void hal_host_raise_vblank();
+#endif
+
+#endif
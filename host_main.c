@@ -0,0 +1,97 @@
+// Headless driver for the HAL_HOST build: steps the frame loop as fast as the
+// host allows and reports the final state and frames per second
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "game.h"
+#include "level.h"
+#include "frame.h"
+#include "input.h"
+#include "profile.h"
+
+// Pick buttons for a frame with a small xorshift generator so runs repeat
+unsigned short scripted_buttons(unsigned int* seed) {
+    unsigned int s = *seed;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    *seed = s;
+
+    unsigned short held = 0;
+    if ((s & 3) == 0) {
+        held |= BUTTON_A;
+    }
+    if (((s >> 8) & 15) == 0) {
+        held |= BUTTON_LEFT;
+    } else if (((s >> 8) & 15) == 1) {
+        held |= BUTTON_RIGHT;
+    } else if (((s >> 8) & 15) == 2) {
+        held |= BUTTON_L;
+    } else if (((s >> 8) & 15) == 3) {
+        held |= BUTTON_R;
+    }
+    return held;
+}
+
+int main(int argc, char** argv) {
+    long frames = argc > 1 ? atol(argv[1]) : 1000000;
+    unsigned int seed = argc > 2 ? (unsigned int) strtoul(argv[2], NULL, 0) : 1;
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    hal_host_init();
+    *display_control = MODE0 | BG0_ENABLE | BG1_ENABLE | BG2_ENABLE | BG3_ENABLE | SPRITE_ENABLE | SPRITE_MAP_1D;
+    hal_cycles_start();
+    setup_background();
+    setup_sprite_image();
+    unsigned int boot_cycles = hal_cycles();
+
+    struct Game game;
+    game_init(&game);
+    frame_init();
+    long late_frames = 0;
+    PROFILE_BEGIN(PROFILE_BUSY);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < frames; i++) {
+        game_update(&game);
+        PROFILE_END(PROFILE_BUSY);
+        if (frame_wait() != 1) {
+            late_frames++;
+        }
+        PROFILE_FRAME();
+        PROFILE_BEGIN(PROFILE_BUSY);
+        hal_host_set_buttons(scripted_buttons(&seed));
+        PROFILE_BEGIN(PROFILE_INPUT);
+        input_poll();
+        PROFILE_END(PROFILE_INPUT);
+        game_draw(&game);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("frames: %ld (vblanks counted: %u, late: %ld)\n", frames, frame_count, late_frames);
+    printf("lander: x=%d y=%d xvel=%d yvel=%d fuel=%x score=%x\n",
+            game.lander.x, game.lander.y, game.lander.xvel, game.lander.yvel,
+            game.lander.fuel, game.lander.score);
+    printf("scroll: x=%d y=%d\n", game.xscroll, game.yscroll);
+    printf("sprites: %d in use\n", sprite_high_water);
+    printf("boot: %u cycles to load backgrounds and sprites\n", boot_cycles);
+    printf("level: %d%s, the last generated in %u cycles\n", game.level,
+            game.level > 1 && level_cavern ? " (cavern)" : "", level_cycles);
+    printf("time: %.3f s (%.0f frames/s)\n", seconds, seconds > 0 ? frames / seconds : 0.0);
+#ifdef PROFILE
+    // Host time scaled to GBA cycles, so only the proportions carry over
+    printf("profile over the last %d frames (cycles of %d per frame):\n", PROFILE_WINDOW, CYCLES_PER_FRAME);
+    for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+        struct ProfileSummary summary;
+        profile_summary(stage, &summary);
+        printf("  %-18s min %7u  avg %7u  max %7u\n", profile_names[stage], summary.min, summary.avg, summary.max);
+    }
+#endif
+    return 0;
+}
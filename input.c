@@ -0,0 +1,32 @@
+#include "hal.h"
+#include "input.h"
+#include "replay.h"
+
+// Buttons held in the current and the previous snapshot
+unsigned short input_keys = 0;
+unsigned short input_last_keys = 0;
+
+// Take the one snapshot of the buttons for this frame
+void input_poll() {
+    input_last_keys = input_keys;
+
+    if (replay_mode == REPLAY_PLAY) {
+        input_keys = replay_next_keys();
+        return;
+    }
+
+    // The key input register reads 0 for a held button
+    input_keys = ~*buttons & BUTTON_MASK;
+    // A full log stops the recording there, rather than going on with frames
+    // missing from it; replay_overflow tells whoever reads the log
+    if (replay_mode == REPLAY_RECORD && !replay_record_keys(input_keys)) {
+        replay_overflow = 1;
+        replay_stop();
+    }
+}
+
+// Forget both snapshots
+void input_reset() {
+    input_keys = 0;
+    input_last_keys = 0;
+}
@@ -0,0 +1,24 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// Buttons held in the current and the previous snapshot (BUTTON_* bits, 1 = held)
+extern unsigned short input_keys;
+extern unsigned short input_last_keys;
+
+// Take the one snapshot of the buttons for this frame; call once per frame
+// at the start of vblank, everything else reads the snapshot
+void input_poll();
+
+// Forget both snapshots, as if no button had been held
+void input_reset();
+
+// Whether any of the buttons is held in this frame's snapshot
+#define input_held(button) ((input_keys & (button)) != 0)
+
+// Whether any of the buttons went down since the previous snapshot
+#define input_pressed(button) ((input_keys & ~input_last_keys & (button)) != 0)
+
+// Whether any of the buttons came up since the previous snapshot
+#define input_released(button) ((~input_keys & input_last_keys & (button)) != 0)
+
+#endif
@@ -0,0 +1,134 @@
+#include "hal.h"
+#include "level.h"
+#include "terrain.h"
+#include "transfer.h"
+
+// Tile map of the generated level, word aligned for the DMA fills
+unsigned short level_map[LEVEL_WIDTH * LEVEL_HEIGHT] EWRAM_DATA __attribute__((aligned(4)));
+
+// Surface row of each tile column
+unsigned char level_surface[LEVEL_WIDTH];
+
+// Whether the level is a cavern, and the row below the roof in each column
+int level_cavern;
+unsigned char level_roof[LEVEL_WIDTH];
+
+// Landing pads: first column and width, in tiles
+int level_pad_count;
+unsigned char level_pad_column[LEVEL_MAX_PADS];
+unsigned char level_pad_width[LEVEL_MAX_PADS];
+
+// Cycles the last level_generate took
+unsigned int level_cycles;
+
+// Next number of an xorshift generator (state not 0)
+unsigned int level_random(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Random number from 0 to range - 1, scaled from the top 16 bits
+int level_pick(unsigned int* state, int range) {
+    return (int) (((level_random(state) >> 16) * (unsigned int) range) >> 16);
+}
+
+// Whether level number n (the world map being level 1) is a cavern
+int level_is_cavern(int n) {
+    return n % LEVEL_CAVERN_EVERY == 0;
+}
+
+// Build the level for a seed (not 0) into level_map and the terrain tables
+void level_generate(unsigned int seed, int cavern) {
+    unsigned int start = hal_cycles();
+    unsigned int state = seed;
+
+    // One pad somewhere in each of count equal stretches of the level, with
+    // at least a column of rough ground between two pads
+    level_pad_count = LEVEL_MIN_PADS + level_pick(&state, LEVEL_MAX_PADS - LEVEL_MIN_PADS + 1);
+    int stretch = LEVEL_WIDTH / level_pad_count;
+    for (int i = 0; i < level_pad_count; i++) {
+        int width = LEVEL_MIN_PAD_WIDTH + level_pick(&state, LEVEL_MAX_PAD_WIDTH - LEVEL_MIN_PAD_WIDTH + 1);
+        level_pad_width[i] = width;
+        level_pad_column[i] = i * stretch + 1 + level_pick(&state, stretch - width - 1);
+    }
+
+    // Walk the surface across the level a row up or down every column, so
+    // only the pads are flat: mostly on in the same direction, which makes
+    // staircase slopes, now and then a cliff. Held level over the pads
+    int surface = LEVEL_TOP_ROW + level_pick(&state, LEVEL_BOTTOM_ROW - LEVEL_TOP_ROW + 1);
+    int step = 1;
+    int pad = 0;
+    for (int column = 0; column < LEVEL_WIDTH; column++) {
+        if (pad < level_pad_count && column >= level_pad_column[pad]) {
+            if (column == level_pad_column[pad] + level_pad_width[pad] - 1) {
+                pad++;
+            }
+        } else {
+            if (level_pick(&state, 4) == 0) {
+                step = -step;
+            }
+            int rise = level_pick(&state, 16) == 0 ? step * 4 : step;
+            // Turn back at the top and bottom rather than run flat along them
+            if (surface + rise < LEVEL_TOP_ROW || surface + rise > LEVEL_BOTTOM_ROW) {
+                step = -step;
+                rise = -rise;
+            }
+            surface += rise;
+        }
+        level_surface[column] = surface;
+    }
+
+    // The underside of the roof walks the same way, held between the roof's
+    // top row and LEVEL_MIN_CLEARANCE rows above the surface, so the pads
+    // always have room to land on. Then the shafts are cut through it
+    level_cavern = cavern;
+    for (int column = 0; column < LEVEL_WIDTH; column++) {
+        level_roof[column] = LEVEL_ROOF_ROW;
+    }
+    if (cavern) {
+        int roof = LEVEL_ROOF_ROW + 1 + level_pick(&state, LEVEL_TOP_ROW - LEVEL_MIN_CLEARANCE - LEVEL_ROOF_ROW);
+        step = 1;
+        for (int column = 0; column < LEVEL_WIDTH; column++) {
+            if (level_pick(&state, 4) == 0) {
+                step = -step;
+            }
+            roof += step;
+            int lowest = level_surface[column] - LEVEL_MIN_CLEARANCE;
+            if (roof < LEVEL_ROOF_ROW + 1 || roof > lowest) {
+                step = -step;
+                roof = roof < LEVEL_ROOF_ROW + 1 ? LEVEL_ROOF_ROW + 1 : lowest;
+            }
+            level_roof[column] = roof;
+        }
+
+        for (int i = 0; i < LEVEL_SHAFTS; i++) {
+            int width = LEVEL_MIN_SHAFT_WIDTH + level_pick(&state, LEVEL_MAX_SHAFT_WIDTH - LEVEL_MIN_SHAFT_WIDTH + 1);
+            int first = i == 0 ? LEVEL_START_COLUMN - width / 2 : level_pick(&state, LEVEL_WIDTH);
+            for (int column = first; column < first + width; column++) {
+                level_roof[column & (LEVEL_WIDTH - 1)] = LEVEL_ROOF_ROW;
+            }
+        }
+    }
+
+    // Open space above the highest row of rock and solid ground below the
+    // lowest surface row, both as word fills; only the rows in between are
+    // built per entry
+    int first_row = cavern ? LEVEL_ROOF_ROW : LEVEL_TOP_ROW;
+    int row_bytes = LEVEL_WIDTH * 2;
+    transfer_fill(level_map, 0, first_row * row_bytes);
+    transfer_fill(level_map + LEVEL_BOTTOM_ROW * LEVEL_WIDTH, LEVEL_GROUND_TILE | (LEVEL_GROUND_TILE << 16),
+            (LEVEL_HEIGHT - LEVEL_BOTTOM_ROW) * row_bytes);
+    unsigned short* entry = level_map + first_row * LEVEL_WIDTH;
+    for (int row = first_row; row < LEVEL_BOTTOM_ROW; row++) {
+        for (int column = 0; column < LEVEL_WIDTH; column++) {
+            *entry++ = row >= level_surface[column] || row < level_roof[column] ? LEVEL_GROUND_TILE : 0;
+        }
+    }
+
+    terrain_init(level_map, LEVEL_WIDTH, LEVEL_HEIGHT);
+    level_cycles = hal_cycles() - start;
+}
@@ -0,0 +1,80 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+/*
+ * Seeded generator for the levels after the first.
+ *
+ * level_generate lays a random walk of surface heights across the level, one
+ * per tile column, with a few landing pads of random width held flat along
+ * the way, then writes the tile map and builds the terrain collision data
+ * from it. The same seed always gives the same level. It runs between
+ * landings, so the rows above and below the surface are filled with DMA and
+ * only the rows the surface passes through are written one entry at a time.
+ *
+ * Every LEVEL_CAVERN_EVERY levels is a cavern: a roof of rock is laid over
+ * the ground with a second walk for its underside, which keeps clear of the
+ * surface, and shafts are cut down through it, one of them over the start.
+ *
+ * The tileset has no slope tiles, so the ground is made of steps of the
+ * solid ground tile.
+ */
+
+// Size of a generated level in tiles (the width a power of two)
+#define LEVEL_WIDTH 128
+#define LEVEL_HEIGHT 64
+
+// Highest and lowest surface row; the lander starts above LEVEL_TOP_ROW
+#define LEVEL_TOP_ROW 28
+#define LEVEL_BOTTOM_ROW 60
+
+// Cavern levels: how often they come, the top row of the roof, rows of air
+// kept between its underside and the surface, and the shafts through it
+#define LEVEL_CAVERN_EVERY 3
+#define LEVEL_ROOF_ROW 12
+#define LEVEL_MIN_CLEARANCE 6
+#define LEVEL_SHAFTS 3
+#define LEVEL_MIN_SHAFT_WIDTH 4
+#define LEVEL_MAX_SHAFT_WIDTH 6
+
+// Tile column under the lander at the start (x 240), kept open on cavern levels
+#define LEVEL_START_COLUMN 30
+
+// Landing pads per level, and their width in tiles
+#define LEVEL_MIN_PADS 3
+#define LEVEL_MAX_PADS 5
+#define LEVEL_MIN_PAD_WIDTH 2
+#define LEVEL_MAX_PAD_WIDTH 5
+
+// Map entry of the ground tile in LunarLanderTiles
+#define LEVEL_GROUND_TILE 1
+
+// Tile map of the generated level, in EWRAM
+extern unsigned short level_map[LEVEL_WIDTH * LEVEL_HEIGHT];
+
+// Surface row of each tile column
+extern unsigned char level_surface[LEVEL_WIDTH];
+
+// Whether the generated level is a cavern, and the row below its roof in
+// each tile column (LEVEL_ROOF_ROW where there is no roof)
+extern int level_cavern;
+extern unsigned char level_roof[LEVEL_WIDTH];
+
+// Landing pads of the generated level: first column and width, in tiles
+extern int level_pad_count;
+extern unsigned char level_pad_column[LEVEL_MAX_PADS];
+extern unsigned char level_pad_width[LEVEL_MAX_PADS];
+
+// Cycles (hal_cycles) the last level_generate took
+extern unsigned int level_cycles;
+
+// Next number of an xorshift generator (state not 0)
+unsigned int level_random(unsigned int* state);
+
+// Whether level number n (the world map being level 1) is a cavern
+int level_is_cavern(int n);
+
+// Build the level for a seed (not 0) into level_map and the terrain tables,
+// as a cavern when cavern is set
+void level_generate(unsigned int seed, int cavern);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+/*
+ * Flight model constants, shared by the game and the host tools that
+ * simulate it. Velocities and accelerations are 8.8 fixed point (fixed.h),
+ * in pixels per frame.
+ */
+
+// Added to the vertical velocity every frame
+#define LANDER_GRAVITY 20
+
+// Added to the velocity along the lander's heading by one frame of main thrust
+#define LANDER_THRUST 40
+
+// Added to or taken off the horizontal velocity by one frame of side thrust
+#define LANDER_RCS 30
+
+// Turn of the lander for each frame L or R is held, in 1/512 turns (fixed.h),
+// and how far it can lean either way from upright (a quarter turn)
+#define LANDER_TURN 4
+#define LANDER_MAX_TILT 128
+
+// Fuel at the start of a game, packed BCD; every frame of thrust uses 1
+#define LANDER_FUEL 0x3000
+
+// Fastest touchdown that still counts as a landing: xvel from 0 to
+// LANDING_MAX_XVEL and yvel up to LANDING_MAX_YVEL
+#define LANDING_MAX_XVEL 511
+#define LANDING_MAX_YVEL 511
+
+// Furthest the lander can lean from upright and still land, in 1/512 turns
+#define LANDING_MAX_TILT 16
+
+// Score for a landing, packed BCD
+#define LANDING_SCORE 0x250
+
+// The parts of the flight model the host tools try other values of. The game
+// reads them from flight_model (game.c), which starts out with the constants
+// above
+struct FlightModel {
+    int gravity;
+    int thrust;
+    int rcs;
+    int max_xvel;
+    int max_yvel;
+};
+
+extern struct FlightModel flight_model;
+
+// Frames the lander stays down after touchdown before it is reset
+#define LANDER_RESET_FRAMES 60
+
+#endif
@@ -0,0 +1,78 @@
+#include "hal.h"
+#include "profile.h"
+
+#ifdef PROFILE
+
+// Palette entry the sky tile is drawn with, recoloured for the raster bars
+#define PROFILE_BAR_ENTRY 4
+
+// Whether to show the stages as raster bars
+int profile_bars = 1;
+
+// Name of each stage, for reports
+const char* const profile_names[PROFILE_STAGES] = {
+    "busy", "input", "UI_update", "lander_update", "collision", "sprite_update_all",
+    "scroll_update"
+};
+
+// Raster bar colour of each stage (BGR555)
+const unsigned short profile_colors[PROFILE_STAGES] = {
+    0x2108, 0x001f, 0x03e0, 0x7c00, 0x03ff, 0x7c1f, 0x7fe0
+};
+
+// Cycle count when each running stage began, and the colour it replaced
+unsigned int profile_start[PROFILE_STAGES];
+unsigned short profile_saved_color[PROFILE_STAGES];
+
+// Cycles of each stage so far this frame
+unsigned int profile_cycles[PROFILE_STAGES];
+
+// Cycles of each stage in the last PROFILE_WINDOW frames, oldest at profile_next
+unsigned int profile_window[PROFILE_STAGES][PROFILE_WINDOW];
+int profile_next = 0;
+int profile_filled = 0;
+
+// Start timing a stage
+void profile_begin(enum ProfileStage stage) {
+    if (profile_bars) {
+        profile_saved_color[stage] = bg_palette[PROFILE_BAR_ENTRY];
+        bg_palette[PROFILE_BAR_ENTRY] = profile_colors[stage];
+    }
+    profile_start[stage] = hal_cycles();
+}
+
+// Stop timing a stage and add its cycles to the frame
+void profile_end(enum ProfileStage stage) {
+    profile_cycles[stage] += hal_cycles() - profile_start[stage];
+    if (profile_bars) {
+        bg_palette[PROFILE_BAR_ENTRY] = profile_saved_color[stage];
+    }
+}
+
+// Close the frame: store the cycles of every stage in the window
+void profile_frame() {
+    for (int stage = 0; stage < PROFILE_STAGES; stage++) {
+        profile_window[stage][profile_next] = profile_cycles[stage];
+        profile_cycles[stage] = 0;
+    }
+    profile_next = (profile_next + 1) % PROFILE_WINDOW;
+    if (profile_filled < PROFILE_WINDOW) {
+        profile_filled++;
+    }
+}
+
+// Min, average and max of a stage over the frames in the window
+void profile_summary(enum ProfileStage stage, struct ProfileSummary* summary) {
+    unsigned int min = 0xffffffff, max = 0, sum = 0;
+    for (int i = 0; i < profile_filled; i++) {
+        unsigned int cycles = profile_window[stage][i];
+        min = cycles < min ? cycles : min;
+        max = cycles > max ? cycles : max;
+        sum += cycles;
+    }
+    summary->min = profile_filled ? min : 0;
+    summary->max = max;
+    summary->avg = profile_filled ? sum / profile_filled : 0;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/*
+ * Per-stage cycle profiler, built in with -DPROFILE (make PROFILE=1).
+ *
+ * Stages are timed with the cycle counter of hal_cycles (timers 0 and 1
+ * cascaded). The cycles of a stage add up over a frame, and profile_frame
+ * keeps each stage's frame total for the last PROFILE_WINDOW frames, from
+ * which profile_summary gives the min, average and max.
+ *
+ * While profile_bars is set, the sky colour changes while a stage runs, so
+ * each stage shows up as a band of scanlines as tall as the time it took
+ * (stages in vblank, like the OAM flush, have no band).
+ *
+ * Without PROFILE the macros compile to nothing.
+ */
+
+// Stages timed; a stage run inside another one counts towards both
+enum ProfileStage {
+    PROFILE_BUSY, // everything outside the vblank wait
+    PROFILE_INPUT,
+    PROFILE_UI,
+    PROFILE_LANDER,
+    PROFILE_COLLISION, // inside PROFILE_LANDER
+    PROFILE_OAM,
+    PROFILE_SCROLL, // streaming the world map into VRAM
+    PROFILE_STAGES
+};
+
+// Frames in the window the summaries cover
+#define PROFILE_WINDOW 64
+
+// Min, average and max cycles a stage took per frame over the window
+struct ProfileSummary {
+    unsigned int min, avg, max;
+};
+
+#ifdef PROFILE
+
+// Whether to show the stages as raster bars
+extern int profile_bars;
+
+// Name of each stage, for reports
+extern const char* const profile_names[PROFILE_STAGES];
+
+// Start and stop timing a stage
+void profile_begin(enum ProfileStage stage);
+void profile_end(enum ProfileStage stage);
+
+// Close the frame: store the cycles of every stage in the window
+void profile_frame();
+
+// Min, average and max of a stage over the frames in the window
+void profile_summary(enum ProfileStage stage, struct ProfileSummary* summary);
+
+#define PROFILE_BEGIN(stage) profile_begin(stage)
+#define PROFILE_END(stage) profile_end(stage)
+#define PROFILE_FRAME() profile_frame()
+
+#else
+
+#define PROFILE_BEGIN(stage) ((void) 0)
+#define PROFILE_END(stage) ((void) 0)
+#define PROFILE_FRAME() ((void) 0)
+
+#endif
+
+#endif
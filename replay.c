@@ -0,0 +1,79 @@
+#include "replay.h"
+
+enum ReplayMode replay_mode = REPLAY_OFF;
+
+// Runs in the log and how many of them there is room for
+struct InputRun* replay_runs = 0;
+int replay_count = 0;
+int replay_capacity = 0;
+
+// Whether recording stopped on a full log
+int replay_overflow = 0;
+
+// Where playback is: the run, and the frames of it already used
+int replay_run = 0;
+int replay_frame = 0;
+
+// Start recording the snapshots read from the buttons into runs
+void replay_record(struct InputRun* runs, int capacity) {
+    replay_mode = REPLAY_RECORD;
+    replay_runs = runs;
+    replay_count = 0;
+    replay_capacity = capacity;
+    replay_overflow = 0;
+}
+
+// Start feeding the snapshots from a log instead of the buttons
+void replay_play(const struct InputRun* runs, int count) {
+    replay_mode = REPLAY_PLAY;
+    // Playback never writes to the log
+    replay_runs = (struct InputRun*) runs;
+    replay_count = count;
+    replay_capacity = count;
+    replay_run = 0;
+    replay_frame = 0;
+}
+
+// Stop recording or playing; returns the runs recorded or played
+int replay_stop() {
+    int count = replay_mode == REPLAY_PLAY ? replay_run : replay_count;
+    replay_mode = REPLAY_OFF;
+    return count;
+}
+
+// Add one frame's snapshot to the log being recorded
+int replay_record_keys(unsigned short keys) {
+    // Extend the last run while the buttons stay the same
+    if (replay_count > 0) {
+        struct InputRun* last = &replay_runs[replay_count - 1];
+        if (last->keys == keys && last->frames < 0xffff) {
+            last->frames++;
+            return 1;
+        }
+    }
+    if (replay_count == replay_capacity) {
+        return 0;
+    }
+    replay_runs[replay_count].keys = keys;
+    replay_runs[replay_count].frames = 1;
+    replay_count++;
+    return 1;
+}
+
+// Next frame's snapshot from the log being played
+unsigned short replay_next_keys() {
+    if (replay_run >= replay_count) {
+        return 0;
+    }
+    unsigned short keys = replay_runs[replay_run].keys;
+    if (++replay_frame >= replay_runs[replay_run].frames) {
+        replay_run++;
+        replay_frame = 0;
+    }
+    return keys;
+}
+
+// Whether the log being played has run out
+int replay_finished() {
+    return replay_run >= replay_count;
+}
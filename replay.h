@@ -0,0 +1,55 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/*
+ * Input logs for recording and replaying a game.
+ *
+ * A log is the button snapshot of every frame, stored as runs of frames with
+ * the same buttons held, so a 10 minute session is usually a few hundred
+ * runs. The game is deterministic given its buttons, so replaying a log from
+ * game_init reproduces the session exactly.
+ */
+
+// Frames in a row with the same buttons held (BUTTON_* bits)
+struct InputRun {
+    unsigned short keys;
+    unsigned short frames;
+};
+
+enum ReplayMode {
+    REPLAY_OFF,
+    REPLAY_RECORD,
+    REPLAY_PLAY
+};
+
+extern enum ReplayMode replay_mode;
+
+// Runs in the log and how many of them there is room for
+extern struct InputRun* replay_runs;
+extern int replay_count;
+extern int replay_capacity;
+
+// Set when recording stopped because the log was full, so the log is missing
+// the frames after that; cleared by replay_record
+extern int replay_overflow;
+
+// Start recording the snapshots read from the buttons into runs
+void replay_record(struct InputRun* runs, int capacity);
+
+// Start feeding the snapshots from a log instead of the buttons
+void replay_play(const struct InputRun* runs, int count);
+
+// Stop recording or playing; returns the runs recorded or played
+int replay_stop();
+
+// Add one frame's snapshot to the log being recorded; returns 0 when it is
+// full, leaving the snapshot out
+int replay_record_keys(unsigned short keys);
+
+// Next frame's snapshot from the log being played (no buttons once it runs out)
+unsigned short replay_next_keys();
+
+// Whether the log being played has run out
+int replay_finished();
+
+#endif
@@ -0,0 +1,92 @@
+#include "scroll.h"
+
+// Map being streamed, and its size in tiles
+const unsigned short* scroll_map;
+int scroll_width, scroll_height;
+
+// First world column and row held in the screen block
+int scroll_column, scroll_row;
+
+// Whether the next scroll_update copies the whole screen block
+int scroll_refill;
+
+// Map entries copied to the screen block since scroll_load
+unsigned int scroll_copied;
+
+// Copy one world column, for the 32 rows held, to its place in the block
+IWRAM_CODE void scroll_copy_column(volatile unsigned short* block, int column) {
+    const unsigned short* source = scroll_map + (column & (scroll_width - 1));
+    for (int row = scroll_row; row < scroll_row + 32; row++) {
+        unsigned short entry = 0;
+        if (row >= 0 && row < scroll_height) {
+            entry = source[row * scroll_width];
+        }
+        block[((row & 31) << 5) | (column & 31)] = entry;
+    }
+    scroll_copied += 32;
+}
+
+// Copy one world row, for the 32 columns held, to its place in the block
+IWRAM_CODE void scroll_copy_row(volatile unsigned short* block, int row) {
+    volatile unsigned short* dest = block + ((row & 31) << 5);
+    if (row < 0 || row >= scroll_height) {
+        for (int i = 0; i < 32; i++) {
+            dest[i] = 0;
+        }
+    } else {
+        const unsigned short* source = scroll_map + row * scroll_width;
+        int mask = scroll_width - 1;
+        for (int column = scroll_column; column < scroll_column + 32; column++) {
+            dest[column & 31] = source[column & mask];
+        }
+    }
+    scroll_copied += 32;
+}
+
+// Start streaming a map; the next scroll_update fills the whole screen block
+void scroll_load(const unsigned short* map, int width, int height) {
+    scroll_map = map;
+    scroll_width = width;
+    scroll_height = height;
+    scroll_copied = 0;
+    scroll_refill = 1;
+}
+
+// Copy the columns and rows that the view at (xscroll, yscroll) newly shows
+IWRAM_CODE void scroll_update(int xscroll, int yscroll) {
+    volatile unsigned short* block = screen_block(16);
+    // Tile at the top left of the screen (the shifts round negative scrolls down)
+    int column = xscroll >> 3;
+    int row = yscroll >> 3;
+
+    // A new map, or moved further than the block holds, as when the lander is reset
+    if (scroll_refill || column - scroll_column >= 32 || scroll_column - column >= 32
+            || row - scroll_row >= 32 || scroll_row - row >= 32) {
+        scroll_refill = 0;
+        scroll_column = column;
+        scroll_row = row;
+        for (int i = 0; i < 32; i++) {
+            scroll_copy_row(block, row + i);
+        }
+        return;
+    }
+
+    // Columns first, over the rows held now; the rows copied after them
+    // cover the new columns too
+    while (scroll_column < column) {
+        scroll_column++;
+        scroll_copy_column(block, scroll_column + 31);
+    }
+    while (scroll_column > column) {
+        scroll_column--;
+        scroll_copy_column(block, scroll_column);
+    }
+    while (scroll_row < row) {
+        scroll_row++;
+        scroll_copy_row(block, scroll_row + 31);
+    }
+    while (scroll_row > row) {
+        scroll_row--;
+        scroll_copy_row(block, scroll_row);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef SCROLL_H
+#define SCROLL_H
+
+/*
+ * Streams a world map bigger than a screen block into screen_block(16).
+ *
+ * The screen block is used as a ring buffer of 32x32 tiles: world tile
+ * (column, row) always goes to entry (column & 31, row & 31), which is where
+ * the hardware draws it once the scroll registers wrap at 256 pixels. The
+ * block holds the 32 columns and 32 rows starting at the top left tile on
+ * screen, which covers the 31x21 tiles the screen can show. When the view
+ * scrolls, only the columns and rows it newly exposes are copied from the
+ * map in ROM.
+ *
+ * The world wraps around horizontally; rows above and below it are empty.
+ */
+
+#include "hal.h"
+
+// Map being streamed, and its size in tiles (width a power of two)
+extern const unsigned short* scroll_map;
+extern int scroll_width, scroll_height;
+
+// First world column and row held in the screen block
+extern int scroll_column, scroll_row;
+
+// Whether the next scroll_update copies the whole screen block
+extern int scroll_refill;
+
+// Map entries copied to the screen block since scroll_load
+extern unsigned int scroll_copied;
+
+// Start streaming a map; the next scroll_update fills the whole screen block
+void scroll_load(const unsigned short* map, int width, int height);
+
+// Copy the columns and rows that the view at (xscroll, yscroll) newly shows;
+// call during vblank, before the scroll registers are set
+IWRAM_CODE void scroll_update(int xscroll, int yscroll);
+
+#endif
@@ -0,0 +1,234 @@
+#include "hal.h"
+#include "sprite.h"
+#include "fixed.h"
+
+// Shadow copy of the sprite attribute memory. Word aligned so it can be sent
+// with 32-bit DMA; globals are placed in IWRAM so reading it costs no wait states
+struct Sprite sprites[NUM_SPRITES] __attribute__((aligned(4)));
+// One past the highest sprite in use
+int sprite_high_water = 0;
+
+// Free sprites as a list linked through sprite_next_free, lowest index first
+// so the sprites in use stay packed at the start of OAM
+int sprite_free_head = -1;
+int sprite_next_free[NUM_SPRITES];
+unsigned char sprite_used[NUM_SPRITES];
+
+// First and last sprite changed since the last flush (first > last when clean)
+int oam_dirty_first = NUM_SPRITES;
+int oam_dirty_last = -1;
+
+// Rotation of each affine matrix, and the ones sprite_update_all has to write
+int sprite_affine_angle[NUM_AFFINE];
+unsigned int sprite_affine_dirty = 0;
+
+// Grow the dirty range so the next flush includes the sprite at index
+void sprite_mark_dirty(int index) {
+    if (index < oam_dirty_first) {
+        oam_dirty_first = index;
+    }
+    if (index > oam_dirty_last) {
+        oam_dirty_last = index;
+    }
+}
+
+// Initialize a sprite and return the pointer, which stays valid until
+// sprite_free (NULL when all sprites are in use)
+struct Sprite* sprite_init(int x, int y, enum SpriteSize size,
+        int horizontal_flip, int vertical_flip, int tile_index, int priority) {
+
+    int index = sprite_free_head;
+    if (index < 0) {
+        return 0;
+    }
+    sprite_free_head = sprite_next_free[index];
+    sprite_used[index] = 1;
+    if (index >= sprite_high_water) {
+        sprite_high_water = index + 1;
+    }
+
+    int size_bits, shape_bits;
+    switch (size) {
+        case SIZE_8_8:   size_bits = 0; shape_bits = 0; break;
+        case SIZE_16_16: size_bits = 1; shape_bits = 0; break;
+        case SIZE_32_32: size_bits = 2; shape_bits = 0; break;
+        case SIZE_64_64: size_bits = 3; shape_bits = 0; break;
+        case SIZE_16_8:  size_bits = 0; shape_bits = 1; break;
+        case SIZE_32_8:  size_bits = 1; shape_bits = 1; break;
+        case SIZE_32_16: size_bits = 2; shape_bits = 1; break;
+        case SIZE_64_32: size_bits = 3; shape_bits = 1; break;
+        case SIZE_8_16:  size_bits = 0; shape_bits = 2; break;
+        case SIZE_8_32:  size_bits = 1; shape_bits = 2; break;
+        case SIZE_16_32: size_bits = 2; shape_bits = 2; break;
+        case SIZE_32_64: size_bits = 3; shape_bits = 2; break;
+        // Not a size the hardware has: fall back to 8x8
+        default:         size_bits = 0; shape_bits = 0; break;
+    }
+
+    int h = horizontal_flip ? 1 : 0;
+    int v = vertical_flip ? 1 : 0;
+
+    sprites[index].attribute0 = y |            
+        (0 << 8) |        
+        (0 << 10) |         
+        (0 << 12) |      
+        (0 << 13) |         
+        (shape_bits << 14);
+
+    sprites[index].attribute1 = x |            
+        (0 << 9) |       
+        (h << 12) |        
+        (v << 13) |         
+        (size_bits << 14); 
+
+    sprites[index].attribute2 = tile_index |   
+        (priority << 10) | 
+        (0 << 12);         
+
+    sprite_mark_dirty(index);
+    return &sprites[index];
+}
+
+// Copy the sprites changed since the last call to OAM
+IWRAM_CODE void sprite_update_all() {
+    // Write the matrices turned this frame; each takes two lookups in the
+    // sine table and goes into the four sprites that hold it
+    for (int matrix = 0; sprite_affine_dirty; matrix++, sprite_affine_dirty >>= 1) {
+        if (sprite_affine_dirty & 1) {
+            short parameters[4];
+            sprite_rotation(sprite_affine_angle[matrix], parameters);
+            for (int i = 0; i < 4; i++) {
+                sprites[matrix * 4 + i].attribute3 = parameters[i];
+            }
+            sprite_mark_dirty(matrix * 4);
+            sprite_mark_dirty(matrix * 4 + 3);
+        }
+    }
+
+    // Nothing moved or changed this frame, so leave OAM alone
+    if (oam_dirty_first > oam_dirty_last) {
+        return;
+    }
+
+    // Each sprite is 8 bytes, so 2 words per sprite
+    int words = (oam_dirty_last - oam_dirty_first + 1) * 2;
+    hal_dma3(&sprite_attribute_memory[oam_dirty_first * 4], &sprites[oam_dirty_first], words | DMA_32 | DMA_ENABLE);
+
+    oam_dirty_first = NUM_SPRITES;
+    oam_dirty_last = -1;
+}
+
+// Set up sprites and splace offscreen
+void sprite_clear() {
+    sprite_high_water = 0;
+
+    for(int i = 0; i < NUM_SPRITES; i++) {
+        sprites[i].attribute0 = SCREEN_HEIGHT;
+        sprites[i].attribute1 = SCREEN_WIDTH;
+        sprite_used[i] = 0;
+        sprite_next_free[i] = i + 1 < NUM_SPRITES ? i + 1 : -1;
+    }
+    sprite_free_head = 0;
+
+    // Start every matrix unrotated
+    for (int i = 0; i < NUM_AFFINE; i++) {
+        sprite_affine_angle[i] = 0;
+    }
+    sprite_affine_dirty = 0xffffffff;
+
+    // Hide every entry left in OAM from before
+    oam_dirty_first = 0;
+    oam_dirty_last = NUM_SPRITES - 1;
+}
+
+// Hide a sprite and give its slot back for sprite_init to reuse
+void sprite_free(struct Sprite* sprite) {
+    int index = sprite - sprites;
+    if (!sprite_used[index]) {
+        return;
+    }
+    sprite_used[index] = 0;
+
+    // Hide it, the next flush clears it from OAM
+    sprite->attribute0 = SPRITE_HIDDEN;
+    sprite_mark_dirty(index);
+
+    // Keep the free list sorted
+    int* link = &sprite_free_head;
+    while (*link >= 0 && *link < index) {
+        link = &sprite_next_free[*link];
+    }
+    sprite_next_free[index] = *link;
+    *link = index;
+
+    // Lower the high-water mark past any free sprites at the top
+    while (sprite_high_water > 0 && !sprite_used[sprite_high_water - 1]) {
+        sprite_high_water--;
+    }
+}
+
+// Set sprite position
+void sprite_position(struct Sprite* sprite, int x, int y) {
+    unsigned short attribute0 = (sprite->attribute0 & 0xff00) | (y & 0xff);
+    unsigned short attribute1 = (sprite->attribute1 & 0xfe00) | (x & 0x1ff);
+
+    if (attribute0 != sprite->attribute0 || attribute1 != sprite->attribute1) {
+        sprite->attribute0 = attribute0;
+        sprite->attribute1 = attribute1;
+        sprite_mark_dirty(sprite - sprites);
+    }
+}
+
+// Move a sprite
+void sprite_move(struct Sprite* sprite, int dx, int dy) {
+    int y = sprite->attribute0 & 0xff;
+    int x = sprite->attribute1 & 0x1ff;
+    sprite_position(sprite, x + dx, y + dy);
+}
+
+// Change tile offset for a sprite
+void sprite_set_offset(struct Sprite* sprite, int offset) {
+    unsigned short attribute2 = sprite->attribute2 & 0xfc00; // clear sprite offset
+    attribute2 |= (offset & 0x03ff); // set sprite offset
+
+    if (attribute2 != sprite->attribute2) {
+        sprite->attribute2 = attribute2;
+        sprite_mark_dirty(sprite - sprites);
+    }
+}
+
+// Swap between two sprite offsets
+void flip_sprite(struct Sprite* sprite, int spriteOffset1, int spriteOffset2) {
+    if ((sprite->attribute2 & 0x03ff) == spriteOffset1) {
+        sprite_set_offset(sprite, spriteOffset2);
+    } else {
+        sprite_set_offset(sprite, spriteOffset1);
+    }
+}
+
+// Draw a sprite through an affine matrix, in a box twice its size
+void sprite_affine(struct Sprite* sprite, int matrix) {
+    sprite->attribute0 |= (1 << 8) | (1 << 9); // affine, double size
+    sprite->attribute1 = (sprite->attribute1 & ~0x3e00) | (matrix << 9); // matrix in place of the flips
+    sprite_mark_dirty(sprite - sprites);
+}
+
+// Turn an affine matrix clockwise to an angle in 1/512 turns
+void sprite_rotate(int matrix, int angle) {
+    angle &= FIXED_ANGLES - 1;
+    if (angle != sprite_affine_angle[matrix]) {
+        sprite_affine_angle[matrix] = angle;
+        sprite_affine_dirty |= 1u << matrix;
+    }
+}
+
+// pa, pb, pc and pd of the matrix for an angle. The matrix goes from the
+// screen to the tile, so it turns the other way to the sprite
+void sprite_rotation(int angle, short* matrix) {
+    int sine = fixed_sin(angle) >> (FIXED_SIN_SHIFT - FIXED8_SHIFT);
+    int cosine = fixed_cos(angle) >> (FIXED_SIN_SHIFT - FIXED8_SHIFT);
+    matrix[0] = cosine;
+    matrix[1] = sine;
+    matrix[2] = -sine;
+    matrix[3] = cosine;
+}
@@ -0,0 +1,96 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include "hal.h"
+
+#define NUM_SPRITES 128
+
+// Struct for storing the 4 sprite attributes
+struct Sprite {
+    unsigned short attribute0;
+    unsigned short attribute1;
+    unsigned short attribute2;
+    unsigned short attribute3;
+};
+
+// Sprite sizes
+enum SpriteSize {
+    SIZE_8_8,
+    SIZE_16_16,
+    SIZE_32_32,
+    SIZE_64_64,
+    SIZE_16_8,
+    SIZE_32_8,
+    SIZE_32_16,
+    SIZE_64_32,
+    SIZE_8_16,
+    SIZE_8_32,
+    SIZE_16_32,
+    SIZE_32_64
+};
+
+// Shadow copy of the sprite attribute memory, flushed to OAM in vblank
+extern struct Sprite sprites[NUM_SPRITES];
+// High-water mark: one past the highest sprite in use
+extern int sprite_high_water;
+
+// First and last sprite changed since the last flush (first > last when clean)
+extern int oam_dirty_first;
+extern int oam_dirty_last;
+
+// Attribute 0 of a sprite that is not drawn (the disable bit)
+#define SPRITE_HIDDEN (1 << 9)
+
+// OBJ affine matrices. Matrix n is kept in attribute 3 of sprites 4n to 4n + 3
+// (pa, pb, pc, pd, 8.8), which map a pixel on screen back to the sprite's tile
+#define NUM_AFFINE 32
+
+// Rotation of each affine matrix in 1/512 turns (fixed.h), and the matrices
+// rotated since the last flush, bit n for matrix n
+extern int sprite_affine_angle[NUM_AFFINE];
+extern unsigned int sprite_affine_dirty;
+
+// Grow the dirty range so the next flush includes the sprite at index; call
+// after writing to sprites[] directly
+void sprite_mark_dirty(int index);
+
+// Initialize a sprite and return the pointer, which stays valid until
+// sprite_free (NULL when all sprites are in use)
+struct Sprite* sprite_init(int x, int y, enum SpriteSize size,
+        int horizontal_flip, int vertical_flip, int tile_index, int priority);
+
+// Hide a sprite and give its slot back for sprite_init to reuse
+void sprite_free(struct Sprite* sprite);
+
+// Copy the sprites changed since the last call to OAM
+IWRAM_CODE void sprite_update_all();
+
+// Set up sprites and place offscreen, freeing all of them
+void sprite_clear();
+
+// Set sprite position
+void sprite_position(struct Sprite* sprite, int x, int y);
+
+// Move a sprite
+void sprite_move(struct Sprite* sprite, int dx, int dy);
+
+// Change tile offset for a sprite
+void sprite_set_offset(struct Sprite* sprite, int offset);
+
+// Swap between two sprite offsets
+void flip_sprite(struct Sprite* sprite, int spriteOffset1, int spriteOffset2);
+
+// Draw a sprite through an affine matrix, in a box twice its size so its
+// corners are not cut off when it turns. The box is centred on the sprite, so
+// place it half the sprite's width and height up and to the left
+void sprite_affine(struct Sprite* sprite, int matrix);
+
+// Turn an affine matrix clockwise to an angle in 1/512 turns. Only the angle
+// is stored; sprite_update_all writes the matrices that changed into the
+// shadow OAM once a frame, before copying it
+void sprite_rotate(int matrix, int angle);
+
+// pa, pb, pc and pd of the matrix for an angle, from the sine table
+void sprite_rotation(int angle, short* matrix);
+
+#endif
@@ -0,0 +1,341 @@
+#include "terrain.h"
+#include "assets.h"
+#include "fixed.h"
+
+// Size of the loaded terrain in pixels
+int terrain_width = TERRAIN_MAX_COLUMNS * 8;
+int terrain_height = TERRAIN_MAX_ROWS * 8;
+
+// Solid tiles of each tile column, bit n for row n
+unsigned long long terrain_solid[TERRAIN_MAX_COLUMNS];
+
+// Tile map the terrain was built from, and its width in tiles
+const unsigned short* terrain_map;
+int terrain_map_width;
+
+// Build the bitset from a tile map, width and height given in tiles
+void terrain_init(const unsigned short* map, int width, int height) {
+    terrain_width = width * 8;
+    terrain_height = height * 8;
+    terrain_map = map;
+    terrain_map_width = width;
+
+    for (int column = 0; column < width; column++) {
+        unsigned long long rows = 0;
+        for (int row = 0; row < height; row++) {
+            // Flip and palette bits don't change whether a tile has pixels
+            int tile = map[row * width + column] & 0x3ff;
+            if (tile < LunarLanderTiles_tiles && (LunarLanderTiles_solid[tile >> 5] >> (tile & 31)) & 1) {
+                rows |= 1ull << row;
+            }
+        }
+        terrain_solid[column] = rows;
+    }
+}
+
+// Solid tiles of the columns left to right, ORed together
+unsigned long long terrain_columns(int left, int right) {
+    int mask = (terrain_width >> 3) - 1;
+    unsigned long long rows = 0;
+    for (int column = left >> 3; column <= right >> 3; column++) {
+        rows |= terrain_solid[column & mask];
+    }
+    return rows;
+}
+
+// Whether any solid tile overlaps the box
+int terrain_overlaps(int left, int top, int right, int bottom) {
+    if (bottom >= terrain_height) {
+        return 1;
+    }
+    if (bottom < 0) {
+        return 0;
+    }
+    int first = top < 0 ? 0 : top >> 3;
+    int last = bottom >> 3;
+    // Bits first to last; 2 << 63 comes out as 0, which still leaves all 64 set
+    return ((terrain_columns(left, right) >> first) & ((2ull << (last - first)) - 1)) != 0;
+}
+
+// Drawn pixels of a line of the tile at (column, row), bit n for pixel n
+unsigned int terrain_line(int column, int row, int line) {
+    int entry = terrain_map[row * terrain_map_width + (column & (terrain_map_width - 1))];
+    // Vertical flip
+    if (entry & 0x0800) {
+        line = 7 - line;
+    }
+    unsigned int bits = LunarLanderTiles_mask[(entry & 0x03ff) * 8 + line];
+    // Horizontal flip: reverse the byte
+    if (entry & 0x0400) {
+        bits = ((bits & 0xf0) >> 4) | ((bits & 0x0f) << 4);
+        bits = ((bits & 0xcc) >> 2) | ((bits & 0x33) << 2);
+        bits = ((bits & 0xaa) >> 1) | ((bits & 0x55) << 1);
+    }
+    return bits;
+}
+
+// Whether the sprite mask covers any drawn pixel of the ground
+int terrain_pixels(int left, int top, const unsigned char* mask, int height) {
+    int bottom = top + height - 1;
+    if (bottom < 0) {
+        return 0;
+    }
+
+    // The sprite's rows cover two tile columns; which of their tile rows
+    // from the sprite's first one down have any pixels
+    int columns = terrain_map_width - 1;
+    int column = left >> 3;
+    int first = top < 0 ? 0 : top >> 3;
+    unsigned int near = terrain_solid[column & columns] >> first;
+    unsigned int far = terrain_solid[(column + 1) & columns] >> first;
+    if (bottom < terrain_height && !((near | far) & ((2u << ((bottom >> 3) - first)) - 1))) {
+        return 0;
+    }
+
+    // Each row of ground under the sprite is the lines of both tiles side by
+    // side, tested against the sprite's row moved to where it is in them
+    int shift = left & 7;
+    for (int i = top < 0 ? -top : 0; i < height; i++) {
+        int y = top + i;
+        if (y >= terrain_height) {
+            if (mask[i]) {
+                return 1;
+            }
+            continue;
+        }
+        int row = (y >> 3) - first;
+        unsigned int ground = 0;
+        if ((near >> row) & 1) {
+            ground = terrain_line(column, y >> 3, y & 7);
+        }
+        if ((far >> row) & 1) {
+            ground |= terrain_line(column + 1, y >> 3, y & 7) << 8;
+        }
+        if (((unsigned int) mask[i] << shift) & ground) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Top of the first solid tile at or below row bottom
+int terrain_floor(int left, int right, int bottom) {
+    int row = bottom < 0 ? 0 : bottom >> 3;
+    if (row >= (terrain_height >> 3)) {
+        return row * 8;
+    }
+    unsigned long long rows = terrain_columns(left, right) >> row;
+    if (!rows) {
+        return terrain_height;
+    }
+    return (row + __builtin_ctzll(rows)) * 8;
+}
+
+// Just below the last solid tile at or above row top
+int terrain_ceiling(int left, int right, int top) {
+    if (top < 0) {
+        return TERRAIN_SKY;
+    }
+    int row = top >> 3;
+    if (row >= (terrain_height >> 3)) {
+        row = (terrain_height >> 3) - 1;
+    }
+    unsigned long long rows = terrain_columns(left, right) & ((2ull << row) - 1);
+    if (!rows) {
+        return TERRAIN_SKY;
+    }
+    return (64 - __builtin_clzll(rows)) * 8;
+}
+
+// Pixels of open space between the box and the ground
+int terrain_altitude(int left, int right, int bottom) {
+    return terrain_floor(left, right, bottom) - bottom - 1;
+}
+
+// Whether the box stands on flat and level ground from left - 1 to right + 1
+int terrain_flat(int left, int right, int bottom) {
+    // Feet on the top of a tile row
+    int row = (bottom + 1) >> 3;
+    if (((bottom + 1) & 7) || row < 1 || row >= (terrain_height >> 3)) {
+        return 0;
+    }
+    // Every column has ground on that row and open space on the row above
+    int mask = (terrain_width >> 3) - 1;
+    for (int column = (left - 1) >> 3; column <= (right + 1) >> 3; column++) {
+        if (((terrain_solid[column & mask] >> (row - 1)) & 3) != 2) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Contact where the box is stopped after moving (dx, dy) of a move of
+// length distance along the axis it was measured on (under 256)
+void terrain_contact(struct TerrainContact* contact, int dx, int dy, int done, int distance, int nx, int ny) {
+    contact->hit = 1;
+    contact->dx = dx;
+    contact->dy = dy;
+    contact->time = (done * (fixed_reciprocal[distance] + 1)) >> 8;
+    contact->nx = nx;
+    contact->ny = ny;
+}
+
+// Rows moved after k columns across are (slope * k) >> 16, rounded so the
+// last column gives exactly dy. dy / distance comes from the reciprocal
+// table, a little over it when dy is positive and under when it is negative,
+// which is near enough to land on dy as |dy| * distance < 65536
+int terrain_slope(int dx, int dy) {
+    int distance = dx < 0 ? -dx : dx;
+    return dy * (fixed_reciprocal[distance] + (dy > 0));
+}
+
+// First contact of a box moving by (dx, dy) with a solid tile
+void terrain_sweep_tiles(int left, int top, int right, int bottom, int dx, int dy, struct TerrainContact* contact) {
+    contact->hit = 0;
+    contact->dx = dx;
+    contact->dy = dy;
+    contact->time = 256;
+    contact->nx = 0;
+    contact->ny = 0;
+
+    // Straight up or down: the same columns the whole way
+    if (dx == 0) {
+        if (terrain_overlaps(left, top, right, bottom)) {
+            terrain_contact(contact, 0, 0, 0, 1, 0, -1);
+        } else if (dy > 0) {
+            int floor = terrain_floor(left, right, bottom);
+            if (bottom + dy >= floor) {
+                terrain_contact(contact, 0, floor - 1 - bottom, floor - 1 - bottom, dy, 0, -1);
+            }
+        } else if (dy < 0) {
+            int ceiling = terrain_ceiling(left, right, top);
+            if (top + dy < ceiling) {
+                terrain_contact(contact, 0, ceiling - top, top - ceiling, -dy, 0, 1);
+            }
+        }
+        return;
+    }
+
+    int step = dx > 0 ? 1 : -1;
+    int distance = dx * step;
+    int slope = terrain_slope(dx, dy);
+
+    // Walk stretches of k over which both edges stay in the same tiles
+    int k0 = 0;
+    while (k0 <= distance) {
+        int x_left = left + step * k0;
+        int x_right = right + step * k0;
+        int k1 = step > 0
+                ? k0 + 7 - ((x_left & 7) > (x_right & 7) ? (x_left & 7) : (x_right & 7))
+                : k0 + ((x_left & 7) < (x_right & 7) ? (x_left & 7) : (x_right & 7));
+        if (k1 > distance) {
+            k1 = distance;
+        }
+
+        // Entering these columns at the height the box had a step back
+        int y = k0 == 0 ? 0 : (slope * (k0 - 1)) >> 16;
+        if (terrain_overlaps(x_left, top + y, x_right, bottom + y)) {
+            if (k0 == 0) {
+                // Already in the ground
+                terrain_contact(contact, 0, 0, 0, 1, 0, -1);
+            } else {
+                // They rise into the box: it hit their side
+                terrain_contact(contact, step * (k0 - 1), y, k0 - 1, distance, -step, 0);
+            }
+            return;
+        }
+
+        if (dy > 0) {
+            // Came down onto their floor
+            int floor = terrain_floor(x_left, x_right, bottom + y);
+            if (bottom + ((slope * k1) >> 16) >= floor) {
+                int k = k0;
+                while (bottom + ((slope * k) >> 16) < floor) {
+                    k++;
+                }
+                terrain_contact(contact, step * k, floor - 1 - bottom, k, distance, 0, -1);
+                return;
+            }
+        } else if (dy < 0) {
+            // Went up into their ceiling
+            int ceiling = terrain_ceiling(x_left, x_right, top + y);
+            if (top + ((slope * k1) >> 16) < ceiling) {
+                int k = k0;
+                while (top + ((slope * k) >> 16) >= ceiling) {
+                    k++;
+                }
+                terrain_contact(contact, step * k, ceiling - top, k, distance, 0, 1);
+                return;
+            }
+        }
+
+        k0 = k1 + 1;
+    }
+}
+
+// Carry a move on a pixel at a time from step k (columns across, or rows
+// when dx is 0) until the drawn pixels of the mask meet the ground's; every
+// position before step k is known to be clear
+void terrain_sweep_pixels(int left, int top, int dx, int dy, int k,
+        const unsigned char* mask, int height, struct TerrainContact* contact) {
+    contact->hit = 0;
+    contact->dx = dx;
+    contact->dy = dy;
+    contact->time = 256;
+    contact->nx = 0;
+    contact->ny = 0;
+
+    int rise = dy > 0 ? 1 : -1;
+    if (k == 0 && terrain_pixels(left, top, mask, height)) {
+        // Already in the ground
+        terrain_contact(contact, 0, 0, 0, 1, 0, -1);
+        return;
+    }
+
+    if (dx == 0) {
+        for (int y = rise * k; y != dy; y += rise) {
+            if (terrain_pixels(left, top + y + rise, mask, height)) {
+                terrain_contact(contact, 0, y, y * rise, dy * rise, 0, -rise);
+                return;
+            }
+        }
+        return;
+    }
+
+    int step = dx > 0 ? 1 : -1;
+    int distance = dx * step;
+    int slope = terrain_slope(dx, dy);
+    for (k = k > 0 ? k : 1; k <= distance; k++) {
+        int x = left + step * k;
+        int y = (slope * (k - 1)) >> 16;
+        int y_end = (slope * k) >> 16;
+        // Into the side of the ground at the height of the step before
+        if (terrain_pixels(x, top + y, mask, height)) {
+            terrain_contact(contact, step * (k - 1), y, k - 1, distance, -step, 0);
+            return;
+        }
+        // Down onto it or up into it
+        for (; y != y_end; y += rise) {
+            if (terrain_pixels(x, top + y + rise, mask, height)) {
+                terrain_contact(contact, step * k, y, k, distance, 0, -rise);
+                return;
+            }
+        }
+    }
+}
+
+// First contact of a box, or of the drawn pixels of its mask, moving by (dx, dy)
+void terrain_sweep(int left, int top, int right, int bottom, int dx, int dy,
+        const unsigned char* mask, struct TerrainContact* contact) {
+    terrain_sweep_tiles(left, top, right, bottom, dx, dy, contact);
+    if (!mask || !contact->hit) {
+        return;
+    }
+
+    // Up to the first solid tile the box is clear, so the pixels only need
+    // testing from there: the step of a floor or ceiling contact, the one
+    // after a wall contact, or the start when it began in a solid tile
+    int k = dx == 0 ? contact->dy * (dy > 0 ? 1 : -1)
+            : contact->dx * (dx > 0 ? 1 : -1) + (contact->nx != 0);
+    terrain_sweep_pixels(left, top, dx, dy, k, mask, bottom - top + 1, contact);
+}
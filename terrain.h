@@ -0,0 +1,95 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+/*
+ * Collision data for the ground map, built once when a level is loaded.
+ *
+ * Which tiles are solid is kept as a bitset: one 64-bit word per tile
+ * column, with a bit per tile row, set when the map entry there is a tile of
+ * LunarLanderTiles with any pixel drawn (LunarLanderTiles_solid, worked out
+ * from the pixels by compress_assets). The words of the columns a box spans
+ * are ORed together, and whether the box is inside the ground, the floor
+ * under it and the ceiling over it are then a shift and a mask or a bit scan
+ * each, so overhangs and tunnels cost no more than open ground.
+ *
+ * That treats the tiles and the box as solid all over. terrain_pixels goes
+ * down to the pixels: it tests a sprite's 1-bit mask (sprites_mask) against
+ * the masks of the tiles under it (LunarLanderTiles_mask), one row at a time
+ * as a shift and an AND of 32-bit words, and only reads the tile map for the
+ * rows the bitset says have ground.
+ *
+ * Above the map is open sky and below it is solid rock. It wraps around
+ * horizontally like the tile map does.
+ */
+
+// Biggest terrain supported, in tiles
+#define TERRAIN_MAX_COLUMNS 128
+#define TERRAIN_MAX_ROWS 64
+
+// terrain_ceiling over a box with only sky above it
+#define TERRAIN_SKY -32768
+
+// Size of the loaded terrain in pixels; the width is a power of two
+extern int terrain_width;
+extern int terrain_height;
+
+// Solid tiles of each tile column, bit n for row n
+extern unsigned long long terrain_solid[TERRAIN_MAX_COLUMNS];
+
+// Tile map the terrain was built from, and its width in tiles
+extern const unsigned short* terrain_map;
+extern int terrain_map_width;
+
+// Build the bitset from a tile map, width and height given in tiles
+void terrain_init(const unsigned short* map, int width, int height);
+
+// Whether any solid tile overlaps the box from (left, top) to (right, bottom)
+int terrain_overlaps(int left, int top, int right, int bottom);
+
+// Whether a sprite mask one tile wide (a row per byte, bit n for pixel
+// left + n) with its top left at (left, top) covers any drawn pixel of the ground
+int terrain_pixels(int left, int top, const unsigned char* mask, int height);
+
+// Y of the top of the first solid tile in the columns left to right that
+// starts at or below row bottom (terrain_height when there is none)
+int terrain_floor(int left, int right, int bottom);
+
+// Y just below the last solid tile in the columns left to right that ends at
+// or above row top (TERRAIN_SKY when there is none)
+int terrain_ceiling(int left, int right, int top);
+
+// Pixels of open space between a box spanning left to right with its lowest row
+// at bottom and the ground under it (0 when touching, negative when inside the ground)
+int terrain_altitude(int left, int right, int bottom);
+
+// Whether the box stands on flat and level ground from left - 1 to right + 1,
+// so it has both feet down and a pixel to spare on each side
+int terrain_flat(int left, int right, int bottom);
+
+// First contact of a moving box with the ground
+struct TerrainContact {
+    int hit;
+    int dx, dy; // how far the box moves: up to the contact, or the whole way
+    int time; // fraction of the move made before the contact, in 1/256
+    int nx, ny; // surface normal: (0, -1) for a floor, (0, 1) for a ceiling, (-1, 0) or (1, 0) for a wall
+};
+
+// Sweep the box from (left, top) to (right, bottom) along a move of (dx, dy)
+// pixels and find where it first touches the ground.
+// The columns under the box only change where one of its edges crosses into
+// another tile, so the move is walked tile by tile (DDA): on entering new
+// columns the box is tested against them at the height it had, which finds
+// walls, and then the floor or ceiling of those columns is looked up once,
+// with the contact found pixel by pixel within that tile. The cost is
+// bounded by |dx| / 4 + 2 of those steps and 8 pixel steps, and the line
+// the box follows comes from fixed_reciprocal (fixed.h) rather than a
+// division, so dx and dy must be between -255 and 255.
+// With a mask (one tile wide, a row for each row of the box) the contact is
+// where the sprite's drawn pixels first meet the ground's instead: from
+// where the box first meets a solid tile the move goes on a pixel at a time
+// with terrain_pixels, which costs up to |dx| + |dy| more tests but only
+// happens while the box is up against the ground.
+void terrain_sweep(int left, int top, int right, int bottom, int dx, int dy,
+        const unsigned char* mask, struct TerrainContact* contact);
+
+#endif
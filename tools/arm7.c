@@ -0,0 +1,887 @@
+// Cycle-approximate ARM7TDMI interpreter with the GBA memory map
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arm7.h"
+
+// Condition flags in cpsr
+#define FLAG_N (1u << 31)
+#define FLAG_Z (1u << 30)
+#define FLAG_C (1u << 29)
+#define FLAG_V (1u << 28)
+
+// System mode, which the CPU stays in
+#define MODE_SYSTEM 0x1f
+
+// I/O registers the interpreter itself looks at
+#define IO_REGION 0x04
+#define ROM_REGION 0x08
+
+// Sizes of the memory regions
+#define BIOS_SIZE 0x4000
+#define EWRAM_SIZE 0x40000
+#define IWRAM_SIZE 0x8000
+#define IO_SIZE 0x400
+#define PALETTE_SIZE 0x400
+#define VRAM_SIZE 0x20000
+#define OAM_SIZE 0x400
+
+// Stack arm7_call starts with when sp is not set, the top of the user stack
+#define DEFAULT_SP 0x03007f00
+
+// ROM wait states selected by the WAITCNT fields
+const unsigned char rom_first_waits[4] = { 4, 3, 2, 8 };
+const unsigned char rom_second_waits[2] = { 2, 1 };
+
+// Give a region memory and access cycles; a 32-bit access on a 16-bit bus
+// is two accesses, the second one sequential
+void set_region(struct Arm7* cpu, int region, unsigned char* memory, unsigned int size,
+        int bus32, int n16, int s16) {
+    cpu->memory[region] = memory;
+    cpu->mask[region] = size - 1;
+    cpu->n16[region] = n16;
+    cpu->s16[region] = s16;
+    cpu->n32[region] = bus32 ? n16 : n16 + s16;
+    cpu->s32[region] = bus32 ? s16 : 2 * s16;
+}
+
+void arm7_init(struct Arm7* cpu, unsigned int rom_size) {
+    memset(cpu, 0, sizeof(*cpu));
+    cpu->cpsr = MODE_SYSTEM;
+
+    // The ROM mask needs a power of two
+    unsigned int rom_space = 0x100;
+    while (rom_space < rom_size) {
+        rom_space <<= 1;
+    }
+
+    // Cycles per access on the GBA: IWRAM, OAM and the BIOS are 32-bit with
+    // no waits, EWRAM is 16-bit with 2 waits, palette and VRAM are 16-bit
+    set_region(cpu, 0x00, calloc(BIOS_SIZE, 1), BIOS_SIZE, 1, 1, 1);
+    set_region(cpu, 0x02, calloc(EWRAM_SIZE, 1), EWRAM_SIZE, 0, 3, 3);
+    set_region(cpu, 0x03, calloc(IWRAM_SIZE, 1), IWRAM_SIZE, 1, 1, 1);
+    set_region(cpu, 0x04, calloc(IO_SIZE, 1), IO_SIZE, 1, 1, 1);
+    set_region(cpu, 0x05, calloc(PALETTE_SIZE, 1), PALETTE_SIZE, 0, 1, 1);
+    set_region(cpu, 0x06, calloc(VRAM_SIZE, 1), VRAM_SIZE, 0, 1, 1);
+    set_region(cpu, 0x07, calloc(OAM_SIZE, 1), OAM_SIZE, 1, 1, 1);
+    unsigned char* rom = calloc(rom_space, 1);
+    for (int region = ROM_REGION; region <= 0x0d; region++) {
+        set_region(cpu, region, rom, rom_space, 0, 1, 1);
+    }
+    // Wait states after reset
+    arm7_set_waitcnt(cpu, 0);
+}
+
+void arm7_free(struct Arm7* cpu) {
+    for (int region = 0; region < ROM_REGION; region++) {
+        free(cpu->memory[region]);
+    }
+    free(cpu->memory[ROM_REGION]);
+    memset(cpu->memory, 0, sizeof(cpu->memory));
+}
+
+// Set the ROM wait states from a value of the WAITCNT register (the
+// three ROM mirrors have their own settings)
+void arm7_set_waitcnt(struct Arm7* cpu, unsigned int waitcnt) {
+    for (int state = 0; state < 3; state++) {
+        int first = rom_first_waits[(waitcnt >> (2 + 3 * state)) & 3];
+        int second = state == 0 ? rom_second_waits[(waitcnt >> 4) & 1]
+                : state == 1 ? ((waitcnt >> 7) & 1 ? 1 : 4)
+                : ((waitcnt >> 10) & 1 ? 1 : 8);
+        for (int region = ROM_REGION + 2 * state; region < ROM_REGION + 2 * state + 2; region++) {
+            set_region(cpu, region, cpu->memory[region], cpu->mask[region] + 1, 0, 1 + first, 1 + second);
+        }
+    }
+}
+
+// Host pointer to the byte at a GBA address (NULL outside the memory map)
+unsigned char* arm7_pointer(struct Arm7* cpu, unsigned int address) {
+    int region = (address >> 24) & 0xf;
+    if (!cpu->memory[region] || address >> 28) {
+        return NULL;
+    }
+    return cpu->memory[region] + (address & cpu->mask[region]);
+}
+
+unsigned int arm7_read(struct Arm7* cpu, unsigned int address, int size) {
+    address &= ~(size - 1);
+    unsigned char* p = arm7_pointer(cpu, address);
+    if (!p) {
+        return 0;
+    }
+    if (((address >> 24) & 0xf) == IO_REGION && cpu->io_read) {
+        cpu->io_read(cpu, address & (IO_SIZE - 1));
+    }
+    if (size == 4) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int) p[3] << 24);
+    }
+    if (size == 2) {
+        return p[0] | (p[1] << 8);
+    }
+    return p[0];
+}
+
+void arm7_write(struct Arm7* cpu, unsigned int address, unsigned int value, int size) {
+    address &= ~(size - 1);
+    int region = (address >> 24) & 0xf;
+    // The ROM can't be written
+    if (region >= ROM_REGION) {
+        return;
+    }
+    unsigned char* p = arm7_pointer(cpu, address);
+    if (!p) {
+        return;
+    }
+    for (int i = 0; i < size; i++) {
+        p[i] = value >> (8 * i);
+    }
+    if (region == IO_REGION && cpu->io_write) {
+        cpu->io_write(cpu, address & (IO_SIZE - 1), size);
+    }
+}
+
+// Cycles of one access of size bytes at address
+int arm7_access_cycles(struct Arm7* cpu, unsigned int address, int size, int sequential) {
+    int region = (address >> 24) & 0xf;
+    if (!cpu->memory[region]) {
+        return 1;
+    }
+    if (size == 4) {
+        return sequential ? cpu->s32[region] : cpu->n32[region];
+    }
+    return sequential ? cpu->s16[region] : cpu->n16[region];
+}
+
+// Start executing at address (bit 0 set for Thumb code)
+void arm7_jump(struct Arm7* cpu, unsigned int address) {
+    if (address & 1) {
+        cpu->cpsr |= ARM7_THUMB;
+        cpu->r[15] = address & ~1;
+    } else {
+        cpu->cpsr &= ~ARM7_THUMB;
+        cpu->r[15] = address & ~3;
+    }
+}
+
+// Address of the next instruction
+unsigned int arm7_pc(struct Arm7* cpu) {
+    return cpu->r[15];
+}
+
+//
+// Execution. While an instruction runs, r[15] reads as its address plus two
+// instructions, like the pipelined CPU; the step functions note a branch in
+// branched so the refill can be charged.
+//
+
+// State of the instruction being run
+struct Step {
+    unsigned int address;
+    int cycles;
+    int branched;
+};
+
+int in_thumb(struct Arm7* cpu) {
+    return (cpu->cpsr & ARM7_THUMB) != 0;
+}
+
+// Write a register, treating pc as a branch
+void set_register(struct Arm7* cpu, struct Step* step, int rd, unsigned int value) {
+    if (rd == 15) {
+        cpu->r[15] = value & (in_thumb(cpu) ? ~1u : ~3u);
+        step->branched = 1;
+    } else {
+        cpu->r[rd] = value;
+    }
+}
+
+// Branch and exchange: bit 0 of the address picks Thumb or ARM
+void branch_exchange(struct Arm7* cpu, struct Step* step, unsigned int address) {
+    arm7_jump(cpu, address);
+    step->branched = 1;
+}
+
+void set_nz(struct Arm7* cpu, unsigned int result) {
+    cpu->cpsr &= ~(FLAG_N | FLAG_Z);
+    cpu->cpsr |= result & FLAG_N;
+    if (result == 0) {
+        cpu->cpsr |= FLAG_Z;
+    }
+}
+
+void set_c(struct Arm7* cpu, int carry) {
+    cpu->cpsr = carry ? cpu->cpsr | FLAG_C : cpu->cpsr & ~FLAG_C;
+}
+
+int carry_flag(struct Arm7* cpu) {
+    return (cpu->cpsr & FLAG_C) != 0;
+}
+
+// a + b + carry, setting the flags when set_flags is true
+unsigned int add_with_carry(struct Arm7* cpu, unsigned int a, unsigned int b, int carry, int set_flags) {
+    unsigned long long wide = (unsigned long long) a + b + carry;
+    unsigned int result = (unsigned int) wide;
+    if (set_flags) {
+        set_nz(cpu, result);
+        set_c(cpu, wide >> 32);
+        cpu->cpsr &= ~FLAG_V;
+        if (~(a ^ b) & (a ^ result) & 0x80000000) {
+            cpu->cpsr |= FLAG_V;
+        }
+    }
+    return result;
+}
+
+int condition_passed(struct Arm7* cpu, int condition) {
+    unsigned int f = cpu->cpsr;
+    int n = (f & FLAG_N) != 0, z = (f & FLAG_Z) != 0, c = (f & FLAG_C) != 0, v = (f & FLAG_V) != 0;
+    switch (condition) {
+    case 0x0: return z;
+    case 0x1: return !z;
+    case 0x2: return c;
+    case 0x3: return !c;
+    case 0x4: return n;
+    case 0x5: return !n;
+    case 0x6: return v;
+    case 0x7: return !v;
+    case 0x8: return c && !z;
+    case 0x9: return !c || z;
+    case 0xa: return n == v;
+    case 0xb: return n != v;
+    case 0xc: return !z && n == v;
+    case 0xd: return z || n != v;
+    case 0xe: return 1;
+    default: return 0;
+    }
+}
+
+// Barrel shifter. by_register follows the rules for a shift amount taken
+// from a register, where 0 leaves the value and the carry alone; for an
+// immediate amount, 0 means LSR #32, ASR #32 and RRX
+unsigned int barrel_shift(struct Arm7* cpu, unsigned int value, int type, int amount, int by_register, int* carry) {
+    *carry = carry_flag(cpu);
+    if (by_register && amount == 0) {
+        return value;
+    }
+    switch (type) {
+    case 0: // LSL
+        if (amount == 0) {
+            return value;
+        }
+        if (amount < 32) {
+            *carry = (value >> (32 - amount)) & 1;
+            return value << amount;
+        }
+        *carry = amount == 32 ? value & 1 : 0;
+        return 0;
+    case 1: // LSR
+        if (amount == 0) {
+            amount = 32;
+        }
+        if (amount < 32) {
+            *carry = (value >> (amount - 1)) & 1;
+            return value >> amount;
+        }
+        *carry = amount == 32 ? value >> 31 : 0;
+        return 0;
+    case 2: // ASR
+        if (amount == 0) {
+            amount = 32;
+        }
+        if (amount < 32) {
+            *carry = (value >> (amount - 1)) & 1;
+            return (unsigned int) ((int) value >> amount);
+        }
+        *carry = value >> 31;
+        return (value >> 31) ? 0xffffffff : 0;
+    default: // ROR, or RRX for an immediate 0
+        if (amount == 0) {
+            *carry = value & 1;
+            return (carry_flag(cpu) << 31) | (value >> 1);
+        }
+        amount &= 31;
+        if (amount == 0) {
+            *carry = value >> 31;
+            return value;
+        }
+        *carry = (value >> (amount - 1)) & 1;
+        return (value >> amount) | (value << (32 - amount));
+    }
+}
+
+// Internal cycles of a multiply by rs: fewer when its top bytes are all 0 or 1
+int multiply_cycles(unsigned int rs, int is_signed) {
+    int cycles = 1;
+    unsigned int mask = 0xffffff00;
+    while (cycles < 4) {
+        unsigned int top = rs & mask;
+        if (top == 0 || (is_signed && top == mask)) {
+            break;
+        }
+        cycles++;
+        mask <<= 8;
+    }
+    return cycles;
+}
+
+// Loads and stores, charging the data access
+unsigned int cpu_load(struct Arm7* cpu, struct Step* step, unsigned int address, int size, int sequential) {
+    step->cycles += arm7_access_cycles(cpu, address, size, sequential);
+    return arm7_read(cpu, address, size);
+}
+
+void cpu_store(struct Arm7* cpu, struct Step* step, unsigned int address, unsigned int value, int size, int sequential) {
+    step->cycles += arm7_access_cycles(cpu, address, size, sequential);
+    arm7_write(cpu, address, value, size);
+}
+
+// LDR of a word: a misaligned address rotates the word
+unsigned int cpu_load_word(struct Arm7* cpu, struct Step* step, unsigned int address) {
+    unsigned int value = cpu_load(cpu, step, address, 4, 0);
+    int rotate = (address & 3) * 8;
+    return rotate ? (value >> rotate) | (value << (32 - rotate)) : value;
+}
+
+void cpu_stop(struct Arm7* cpu, const char* what) {
+    cpu->error = what;
+    cpu->stopped = 1;
+}
+
+void arm_data_processing(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int opcode = (op >> 21) & 0xf;
+    int set_flags = (op >> 20) & 1;
+    int rn = (op >> 16) & 0xf;
+    int rd = (op >> 12) & 0xf;
+    unsigned int operand;
+    int carry;
+    unsigned int rn_value = cpu->r[rn];
+
+    if (op & (1 << 25)) {
+        int rotate = ((op >> 8) & 0xf) * 2;
+        operand = op & 0xff;
+        carry = carry_flag(cpu);
+        if (rotate) {
+            operand = (operand >> rotate) | (operand << (32 - rotate));
+            carry = operand >> 31;
+        }
+    } else {
+        int rm = op & 0xf;
+        unsigned int rm_value = cpu->r[rm];
+        int type = (op >> 5) & 3;
+        if (op & (1 << 4)) {
+            // Shift by register takes an extra cycle, and pc reads 4 further on
+            int amount = cpu->r[(op >> 8) & 0xf] & 0xff;
+            step->cycles++;
+            if (rm == 15) {
+                rm_value += 4;
+            }
+            if (rn == 15) {
+                rn_value += 4;
+            }
+            operand = barrel_shift(cpu, rm_value, type, amount, 1, &carry);
+        } else {
+            operand = barrel_shift(cpu, rm_value, type, (op >> 7) & 0x1f, 0, &carry);
+        }
+    }
+
+    unsigned int result;
+    int logical = 0;
+    switch (opcode) {
+    case 0x0: result = rn_value & operand; logical = 1; break;
+    case 0x1: result = rn_value ^ operand; logical = 1; break;
+    case 0x2: result = add_with_carry(cpu, rn_value, ~operand, 1, set_flags); break;
+    case 0x3: result = add_with_carry(cpu, operand, ~rn_value, 1, set_flags); break;
+    case 0x4: result = add_with_carry(cpu, rn_value, operand, 0, set_flags); break;
+    case 0x5: result = add_with_carry(cpu, rn_value, operand, carry_flag(cpu), set_flags); break;
+    case 0x6: result = add_with_carry(cpu, rn_value, ~operand, carry_flag(cpu), set_flags); break;
+    case 0x7: result = add_with_carry(cpu, operand, ~rn_value, carry_flag(cpu), set_flags); break;
+    case 0x8: result = rn_value & operand; logical = 1; break;
+    case 0x9: result = rn_value ^ operand; logical = 1; break;
+    case 0xa: result = add_with_carry(cpu, rn_value, ~operand, 1, set_flags); break;
+    case 0xb: result = add_with_carry(cpu, rn_value, operand, 0, set_flags); break;
+    case 0xc: result = rn_value | operand; logical = 1; break;
+    case 0xd: result = operand; logical = 1; break;
+    case 0xe: result = rn_value & ~operand; logical = 1; break;
+    default: result = ~operand; logical = 1; break;
+    }
+
+    if (set_flags && logical) {
+        set_nz(cpu, result);
+        set_c(cpu, carry);
+    }
+    // TST, TEQ, CMP and CMN only set the flags
+    if (opcode < 0x8 || opcode > 0xb) {
+        set_register(cpu, step, rd, result);
+    }
+}
+
+void arm_multiply(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int rd = (op >> 16) & 0xf;
+    unsigned int rs = cpu->r[(op >> 8) & 0xf];
+    unsigned int result = cpu->r[op & 0xf] * rs;
+
+    step->cycles += multiply_cycles(rs, 1);
+    if (op & (1 << 21)) {
+        // MLA
+        result += cpu->r[(op >> 12) & 0xf];
+        step->cycles++;
+    }
+    cpu->r[rd] = result;
+    if (op & (1 << 20)) {
+        set_nz(cpu, result);
+    }
+}
+
+void arm_multiply_long(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int rd_high = (op >> 16) & 0xf;
+    int rd_low = (op >> 12) & 0xf;
+    unsigned int rs = cpu->r[(op >> 8) & 0xf];
+    unsigned int rm = cpu->r[op & 0xf];
+    int is_signed = (op >> 22) & 1;
+    unsigned long long result;
+
+    if (is_signed) {
+        result = (unsigned long long) ((long long) (int) rm * (int) rs);
+    } else {
+        result = (unsigned long long) rm * rs;
+    }
+    step->cycles += multiply_cycles(rs, is_signed) + 1;
+    if (op & (1 << 21)) {
+        // UMLAL and SMLAL
+        result += ((unsigned long long) cpu->r[rd_high] << 32) | cpu->r[rd_low];
+        step->cycles++;
+    }
+    cpu->r[rd_low] = (unsigned int) result;
+    cpu->r[rd_high] = (unsigned int) (result >> 32);
+    if (op & (1 << 20)) {
+        cpu->cpsr &= ~(FLAG_N | FLAG_Z);
+        cpu->cpsr |= (unsigned int) (result >> 32) & FLAG_N;
+        if (result == 0) {
+            cpu->cpsr |= FLAG_Z;
+        }
+    }
+}
+
+void arm_swap(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int size = (op & (1 << 22)) ? 1 : 4;
+    unsigned int address = cpu->r[(op >> 16) & 0xf];
+    unsigned int value = size == 4 ? cpu_load_word(cpu, step, address) : cpu_load(cpu, step, address, 1, 0);
+    cpu_store(cpu, step, address, cpu->r[op & 0xf], size, 0);
+    step->cycles++;
+    set_register(cpu, step, (op >> 12) & 0xf, value);
+}
+
+// LDR, STR, LDRB and STRB
+void arm_single_transfer(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int pre = (op >> 24) & 1, up = (op >> 23) & 1, byte = (op >> 22) & 1;
+    int writeback = (op >> 21) & 1, is_load = (op >> 20) & 1;
+    int rn = (op >> 16) & 0xf, rd = (op >> 12) & 0xf;
+    unsigned int offset;
+
+    if (op & (1 << 25)) {
+        int carry;
+        offset = barrel_shift(cpu, cpu->r[op & 0xf], (op >> 5) & 3, (op >> 7) & 0x1f, 0, &carry);
+    } else {
+        offset = op & 0xfff;
+    }
+
+    unsigned int base = cpu->r[rn];
+    unsigned int moved = up ? base + offset : base - offset;
+    unsigned int address = pre ? moved : base;
+
+    if (is_load) {
+        unsigned int value = byte ? cpu_load(cpu, step, address, 1, 0) : cpu_load_word(cpu, step, address);
+        step->cycles++;
+        if (!pre || writeback) {
+            cpu->r[rn] = moved;
+        }
+        set_register(cpu, step, rd, value);
+    } else {
+        // A stored pc reads 4 further on
+        unsigned int value = cpu->r[rd] + (rd == 15 ? 4 : 0);
+        cpu_store(cpu, step, address, value, byte ? 1 : 4, 0);
+        if (!pre || writeback) {
+            set_register(cpu, step, rn, moved);
+        }
+    }
+}
+
+// LDRH, STRH, LDRSB and LDRSH
+void arm_halfword_transfer(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int pre = (op >> 24) & 1, up = (op >> 23) & 1, immediate = (op >> 22) & 1;
+    int writeback = (op >> 21) & 1, is_load = (op >> 20) & 1;
+    int rn = (op >> 16) & 0xf, rd = (op >> 12) & 0xf;
+    int kind = (op >> 5) & 3;
+    unsigned int offset = immediate ? ((op >> 4) & 0xf0) | (op & 0xf) : cpu->r[op & 0xf];
+
+    unsigned int base = cpu->r[rn];
+    unsigned int moved = up ? base + offset : base - offset;
+    unsigned int address = pre ? moved : base;
+
+    if (is_load) {
+        unsigned int value;
+        if (kind == 1) {
+            value = cpu_load(cpu, step, address, 2, 0);
+        } else if (kind == 2) {
+            value = (unsigned int) (signed char) cpu_load(cpu, step, address, 1, 0);
+        } else {
+            value = (unsigned int) (short) cpu_load(cpu, step, address, 2, 0);
+        }
+        step->cycles++;
+        if (!pre || writeback) {
+            cpu->r[rn] = moved;
+        }
+        set_register(cpu, step, rd, value);
+    } else {
+        cpu_store(cpu, step, address, cpu->r[rd] + (rd == 15 ? 4 : 0), 2, 0);
+        if (!pre || writeback) {
+            set_register(cpu, step, rn, moved);
+        }
+    }
+}
+
+// LDM and STM; registers go to ascending addresses whatever the direction
+void block_transfer(struct Arm7* cpu, struct Step* step, int rn, unsigned int list,
+        int pre, int up, int writeback, int is_load) {
+    int count = 0;
+    for (int i = 0; i < 16; i++) {
+        count += (list >> i) & 1;
+    }
+    if (count == 0) {
+        return;
+    }
+
+    unsigned int base = cpu->r[rn];
+    unsigned int address = up ? base + (pre ? 4 : 0) : base - 4 * count + (pre ? 0 : 4);
+    unsigned int final = up ? base + 4 * count : base - 4 * count;
+    int sequential = 0;
+
+    if (is_load) {
+        if (writeback) {
+            cpu->r[rn] = final;
+        }
+        for (int i = 0; i < 16; i++) {
+            if (list & (1 << i)) {
+                set_register(cpu, step, i, cpu_load(cpu, step, address, 4, sequential));
+                address += 4;
+                sequential = 1;
+            }
+        }
+        step->cycles++;
+    } else {
+        for (int i = 0; i < 16; i++) {
+            if (list & (1 << i)) {
+                cpu_store(cpu, step, address, cpu->r[i] + (i == 15 ? 4 : 0), 4, sequential);
+                address += 4;
+                sequential = 1;
+            }
+        }
+        if (writeback) {
+            cpu->r[rn] = final;
+        }
+    }
+}
+
+void cpu_swi(struct Arm7* cpu, struct Step* step, int number) {
+    // Entering and leaving the BIOS refills the pipeline twice
+    step->cycles += 2 * (arm7_access_cycles(cpu, 0, 4, 0) + arm7_access_cycles(cpu, 0, 4, 1));
+    if (cpu->swi) {
+        cpu->swi(cpu, number);
+    } else {
+        cpu_stop(cpu, "SWI without a handler");
+    }
+}
+
+void arm_execute(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    if (!condition_passed(cpu, op >> 28)) {
+        return;
+    }
+
+    if ((op & 0x0ffffff0) == 0x012fff10) {
+        branch_exchange(cpu, step, cpu->r[op & 0xf]);
+    } else if ((op & 0x0fc000f0) == 0x00000090) {
+        arm_multiply(cpu, step, op);
+    } else if ((op & 0x0f8000f0) == 0x00800090) {
+        arm_multiply_long(cpu, step, op);
+    } else if ((op & 0x0fb00ff0) == 0x01000090) {
+        arm_swap(cpu, step, op);
+    } else if ((op & 0x0e000090) == 0x00000090 && (op & 0x60)) {
+        arm_halfword_transfer(cpu, step, op);
+    } else if ((op & 0x0fbf0fff) == 0x010f0000) {
+        // MRS
+        cpu->r[(op >> 12) & 0xf] = cpu->cpsr;
+    } else if ((op & 0x0db0f000) == 0x0120f000) {
+        // MSR: the flags and the mode can be set, but the mode has no effect
+        unsigned int value;
+        if (op & (1 << 25)) {
+            int rotate = ((op >> 8) & 0xf) * 2;
+            value = op & 0xff;
+            value = rotate ? (value >> rotate) | (value << (32 - rotate)) : value;
+        } else {
+            value = cpu->r[op & 0xf];
+        }
+        if (!(op & (1 << 22))) {
+            if (op & (1 << 19)) {
+                cpu->cpsr = (cpu->cpsr & 0x00ffffff) | (value & 0xff000000);
+            }
+            if (op & (1 << 16)) {
+                cpu->cpsr = (cpu->cpsr & ~0xdfu) | (value & 0xdf);
+            }
+        }
+    } else if ((op & 0x0c000000) == 0x00000000) {
+        arm_data_processing(cpu, step, op);
+    } else if ((op & 0x0c000000) == 0x04000000) {
+        if ((op & 0x02000010) == 0x02000010) {
+            cpu_stop(cpu, "undefined ARM instruction");
+        } else {
+            arm_single_transfer(cpu, step, op);
+        }
+    } else if ((op & 0x0e000000) == 0x08000000) {
+        block_transfer(cpu, step, (op >> 16) & 0xf, op & 0xffff, (op >> 24) & 1, (op >> 23) & 1,
+                (op >> 21) & 1, (op >> 20) & 1);
+    } else if ((op & 0x0e000000) == 0x0a000000) {
+        // B and BL
+        int offset = (int) (op << 8) >> 6;
+        if (op & (1 << 24)) {
+            cpu->r[14] = step->address + 4;
+        }
+        set_register(cpu, step, 15, cpu->r[15] + offset);
+    } else if ((op & 0x0f000000) == 0x0f000000) {
+        cpu_swi(cpu, step, (op >> 16) & 0xff);
+    } else {
+        cpu_stop(cpu, "coprocessor instruction");
+    }
+}
+
+// Thumb ALU operations (format 4)
+void thumb_alu(struct Arm7* cpu, struct Step* step, int opcode, int rd, int rs) {
+    unsigned int a = cpu->r[rd], b = cpu->r[rs], result;
+    int carry;
+
+    switch (opcode) {
+    case 0x0: result = a & b; set_nz(cpu, result); break;
+    case 0x1: result = a ^ b; set_nz(cpu, result); break;
+    case 0x2: case 0x3: case 0x4: case 0x7:
+        // LSL, LSR, ASR and ROR by register
+        result = barrel_shift(cpu, a, opcode == 0x2 ? 0 : opcode == 0x3 ? 1 : opcode == 0x4 ? 2 : 3, b & 0xff, 1, &carry);
+        set_nz(cpu, result);
+        set_c(cpu, carry);
+        step->cycles++;
+        break;
+    case 0x5: result = add_with_carry(cpu, a, b, carry_flag(cpu), 1); break;
+    case 0x6: result = add_with_carry(cpu, a, ~b, carry_flag(cpu), 1); break;
+    case 0x8: set_nz(cpu, a & b); return;
+    case 0x9: result = add_with_carry(cpu, 0, ~b, 1, 1); break;
+    case 0xa: add_with_carry(cpu, a, ~b, 1, 1); return;
+    case 0xb: add_with_carry(cpu, a, b, 0, 1); return;
+    case 0xc: result = a | b; set_nz(cpu, result); break;
+    case 0xd:
+        result = a * b;
+        set_nz(cpu, result);
+        step->cycles += multiply_cycles(a, 1);
+        break;
+    case 0xe: result = a & ~b; set_nz(cpu, result); break;
+    default: result = ~b; set_nz(cpu, result); break;
+    }
+    cpu->r[rd] = result;
+}
+
+void thumb_execute(struct Arm7* cpu, struct Step* step, unsigned int op) {
+    int rd = op & 7;
+    int rs = (op >> 3) & 7;
+
+    if ((op & 0xf800) == 0x1800) {
+        // Format 2: ADD and SUB with a register or a 3-bit immediate
+        unsigned int operand = (op & 0x0400) ? (op >> 6) & 7 : cpu->r[(op >> 6) & 7];
+        if (op & 0x0200) {
+            cpu->r[rd] = add_with_carry(cpu, cpu->r[rs], ~operand, 1, 1);
+        } else {
+            cpu->r[rd] = add_with_carry(cpu, cpu->r[rs], operand, 0, 1);
+        }
+    } else if ((op & 0xe000) == 0x0000) {
+        // Format 1: shift by an immediate
+        int carry;
+        unsigned int result = barrel_shift(cpu, cpu->r[rs], (op >> 11) & 3, (op >> 6) & 0x1f, 0, &carry);
+        cpu->r[rd] = result;
+        set_nz(cpu, result);
+        set_c(cpu, carry);
+    } else if ((op & 0xe000) == 0x2000) {
+        // Format 3: MOV, CMP, ADD and SUB with an 8-bit immediate
+        int r = (op >> 8) & 7;
+        unsigned int immediate = op & 0xff;
+        switch ((op >> 11) & 3) {
+        case 0: cpu->r[r] = immediate; set_nz(cpu, immediate); break;
+        case 1: add_with_carry(cpu, cpu->r[r], ~immediate, 1, 1); break;
+        case 2: cpu->r[r] = add_with_carry(cpu, cpu->r[r], immediate, 0, 1); break;
+        default: cpu->r[r] = add_with_carry(cpu, cpu->r[r], ~immediate, 1, 1); break;
+        }
+    } else if ((op & 0xfc00) == 0x4000) {
+        thumb_alu(cpu, step, (op >> 6) & 0xf, rd, rs);
+    } else if ((op & 0xfc00) == 0x4400) {
+        // Format 5: high register operations and BX
+        int hd = rd | ((op >> 4) & 8);
+        int hs = (op >> 3) & 0xf;
+        switch ((op >> 8) & 3) {
+        case 0: set_register(cpu, step, hd, cpu->r[hd] + cpu->r[hs]); break;
+        case 1: add_with_carry(cpu, cpu->r[hd], ~cpu->r[hs], 1, 1); break;
+        case 2: set_register(cpu, step, hd, cpu->r[hs]); break;
+        default: branch_exchange(cpu, step, cpu->r[hs]); break;
+        }
+    } else if ((op & 0xf800) == 0x4800) {
+        // Format 6: PC-relative load, from the word-aligned pc
+        unsigned int address = (cpu->r[15] & ~2u) + ((op & 0xff) << 2);
+        cpu->r[(op >> 8) & 7] = cpu_load(cpu, step, address, 4, 0);
+        step->cycles++;
+    } else if ((op & 0xf000) == 0x5000) {
+        // Formats 7 and 8: load and store with a register offset
+        unsigned int address = cpu->r[rs] + cpu->r[(op >> 6) & 7];
+        switch ((op >> 9) & 7) {
+        case 0: cpu_store(cpu, step, address, cpu->r[rd], 4, 0); break;
+        case 1: cpu_store(cpu, step, address, cpu->r[rd], 2, 0); break;
+        case 2: cpu_store(cpu, step, address, cpu->r[rd], 1, 0); break;
+        case 3: cpu->r[rd] = (unsigned int) (signed char) cpu_load(cpu, step, address, 1, 0); step->cycles++; break;
+        case 4: cpu->r[rd] = cpu_load_word(cpu, step, address); step->cycles++; break;
+        case 5: cpu->r[rd] = cpu_load(cpu, step, address, 2, 0); step->cycles++; break;
+        case 6: cpu->r[rd] = cpu_load(cpu, step, address, 1, 0); step->cycles++; break;
+        default: cpu->r[rd] = (unsigned int) (short) cpu_load(cpu, step, address, 2, 0); step->cycles++; break;
+        }
+    } else if ((op & 0xe000) == 0x6000) {
+        // Format 9: load and store with a 5-bit immediate offset
+        int byte = (op >> 12) & 1;
+        unsigned int address = cpu->r[rs] + (((op >> 6) & 0x1f) << (byte ? 0 : 2));
+        if (op & 0x0800) {
+            cpu->r[rd] = byte ? cpu_load(cpu, step, address, 1, 0) : cpu_load_word(cpu, step, address);
+            step->cycles++;
+        } else {
+            cpu_store(cpu, step, address, cpu->r[rd], byte ? 1 : 4, 0);
+        }
+    } else if ((op & 0xf000) == 0x8000) {
+        // Format 10: halfword load and store
+        unsigned int address = cpu->r[rs] + (((op >> 6) & 0x1f) << 1);
+        if (op & 0x0800) {
+            cpu->r[rd] = cpu_load(cpu, step, address, 2, 0);
+            step->cycles++;
+        } else {
+            cpu_store(cpu, step, address, cpu->r[rd], 2, 0);
+        }
+    } else if ((op & 0xf000) == 0x9000) {
+        // Format 11: SP-relative load and store
+        unsigned int address = cpu->r[13] + ((op & 0xff) << 2);
+        int r = (op >> 8) & 7;
+        if (op & 0x0800) {
+            cpu->r[r] = cpu_load_word(cpu, step, address);
+            step->cycles++;
+        } else {
+            cpu_store(cpu, step, address, cpu->r[r], 4, 0);
+        }
+    } else if ((op & 0xf000) == 0xa000) {
+        // Format 12: address from pc or sp
+        unsigned int base = (op & 0x0800) ? cpu->r[13] : cpu->r[15] & ~2u;
+        cpu->r[(op >> 8) & 7] = base + ((op & 0xff) << 2);
+    } else if ((op & 0xff00) == 0xb000) {
+        // Format 13: adjust sp
+        unsigned int offset = (op & 0x7f) << 2;
+        cpu->r[13] = (op & 0x80) ? cpu->r[13] - offset : cpu->r[13] + offset;
+    } else if ((op & 0xf600) == 0xb400) {
+        // Format 14: PUSH and POP, with lr or pc
+        unsigned int list = op & 0xff;
+        if (op & 0x0800) {
+            if (op & 0x0100) {
+                list |= 1 << 15;
+            }
+            block_transfer(cpu, step, 13, list, 0, 1, 1, 1);
+        } else {
+            if (op & 0x0100) {
+                list |= 1 << 14;
+            }
+            block_transfer(cpu, step, 13, list, 1, 0, 1, 0);
+        }
+    } else if ((op & 0xf000) == 0xc000) {
+        // Format 15: LDMIA and STMIA
+        int rb = (op >> 8) & 7;
+        int is_load = (op >> 11) & 1;
+        block_transfer(cpu, step, rb, op & 0xff, 0, 1, !(is_load && (op & (1 << rb))), is_load);
+    } else if ((op & 0xff00) == 0xdf00) {
+        cpu_swi(cpu, step, op & 0xff);
+    } else if ((op & 0xf000) == 0xd000) {
+        // Format 16: conditional branch
+        if ((op & 0x0e00) == 0x0e00) {
+            cpu_stop(cpu, "undefined Thumb instruction");
+        } else if (condition_passed(cpu, (op >> 8) & 0xf)) {
+            set_register(cpu, step, 15, cpu->r[15] + ((int) (signed char) (op & 0xff) << 1));
+        }
+    } else if ((op & 0xf800) == 0xe000) {
+        // Format 18: branch
+        set_register(cpu, step, 15, cpu->r[15] + ((int) (op << 21) >> 20));
+    } else if ((op & 0xf800) == 0xf000) {
+        // Format 19, first half: high part of the offset into lr
+        cpu->r[14] = cpu->r[15] + ((int) (op << 21) >> 9);
+    } else if ((op & 0xf800) == 0xf800) {
+        // Format 19, second half: branch with link
+        unsigned int target = cpu->r[14] + ((op & 0x7ff) << 1);
+        cpu->r[14] = (step->address + 2) | 1;
+        set_register(cpu, step, 15, target);
+    } else {
+        cpu_stop(cpu, "undefined Thumb instruction");
+    }
+}
+
+// Run one instruction and return the cycles it took (0 once stopped)
+int arm7_step(struct Arm7* cpu) {
+    if (cpu->stopped) {
+        return 0;
+    }
+
+    struct Step step;
+    int width = in_thumb(cpu) ? 2 : 4;
+    step.address = cpu->r[15];
+    step.branched = 0;
+    // The fetch of the next instruction goes on while this one runs
+    step.cycles = arm7_access_cycles(cpu, step.address, width, 1);
+
+    unsigned int op = arm7_read(cpu, step.address, width);
+    cpu->r[15] = step.address + 2 * width;
+    if (width == 2) {
+        thumb_execute(cpu, &step, op);
+    } else {
+        arm_execute(cpu, &step, op);
+    }
+
+    if (step.branched) {
+        // Refill the pipeline at the branch target
+        int target_width = in_thumb(cpu) ? 2 : 4;
+        step.cycles += arm7_access_cycles(cpu, cpu->r[15], target_width, 0)
+                + arm7_access_cycles(cpu, cpu->r[15], target_width, 1);
+    } else {
+        cpu->r[15] = step.address + width;
+    }
+
+    cpu->cycles += step.cycles;
+    cpu->instructions++;
+    return step.cycles;
+}
+
+// Call the function at address (bit 0 set for Thumb) with up to 4 arguments,
+// running at most max_instructions; returns r0
+unsigned int arm7_call(struct Arm7* cpu, unsigned int address, const unsigned int* args, int count,
+        unsigned long long max_instructions) {
+    for (int i = 0; i < count && i < 4; i++) {
+        cpu->r[i] = args[i];
+    }
+    if (cpu->r[13] == 0) {
+        cpu->r[13] = DEFAULT_SP;
+    }
+    cpu->r[14] = ARM7_TRAP;
+    arm7_jump(cpu, address);
+
+    unsigned long long limit = cpu->instructions + max_instructions;
+    while (cpu->r[15] != ARM7_TRAP && !cpu->stopped) {
+        if (cpu->instructions >= limit) {
+            cpu_stop(cpu, "call did not return");
+            break;
+        }
+        arm7_step(cpu);
+    }
+    return cpu->r[0];
+}
@@ -0,0 +1,81 @@
+#ifndef ARM7_H
+#define ARM7_H
+
+/*
+ * Cycle-approximate ARM7TDMI interpreter with the GBA memory map, for timing
+ * game code on a host.
+ *
+ * Every instruction is charged the ARM7TDMI cycle counts (S, N and I cycles),
+ * with the length of each S and N access taken from the wait states of the
+ * memory region it touches. So ARM code in IWRAM, Thumb code in ROM and data
+ * in EWRAM cost what they would on the GBA, apart from the ROM prefetch
+ * buffer, which is not modelled.
+ *
+ * There is one register bank: the CPU runs in system mode throughout, and
+ * interrupts and BIOS calls are left to the program using it (see swi and
+ * the io hooks).
+ */
+
+// Return address arm7_call puts in lr; reaching it ends the call
+#define ARM7_TRAP 0x00003ff0
+
+// Mask of the T bit (Thumb state) in cpsr
+#define ARM7_THUMB (1 << 5)
+
+struct Arm7 {
+    unsigned int r[16];
+    unsigned int cpsr; // N Z C V flags in the top bits, the T bit, the mode
+    unsigned long long cycles;
+    unsigned long long instructions;
+
+    // Memory of each region (address >> 24), its address mask and access
+    // cycles for 16-bit and 32-bit, non-sequential and sequential accesses
+    unsigned char* memory[16];
+    unsigned int mask[16];
+    unsigned char n16[16], s16[16], n32[16], s32[16];
+
+    // Called with the offset of an I/O register before it is read, so the
+    // register can be brought up to date, and after it is written
+    void (*io_read)(struct Arm7* cpu, unsigned int offset);
+    void (*io_write)(struct Arm7* cpu, unsigned int offset, int size);
+
+    // Called for a SWI with its number; it can add cycles and set stopped
+    void (*swi)(struct Arm7* cpu, int number);
+
+    void* user;
+    int stopped;
+    // Set when an instruction cannot be run; the CPU stops
+    const char* error;
+};
+
+// Set up the memory map with a ROM of rom_size bytes, all memory cleared
+void arm7_init(struct Arm7* cpu, unsigned int rom_size);
+void arm7_free(struct Arm7* cpu);
+
+// Set the ROM wait states from a value of the WAITCNT register
+void arm7_set_waitcnt(struct Arm7* cpu, unsigned int waitcnt);
+
+// Host pointer to the byte at a GBA address (NULL outside the memory map)
+unsigned char* arm7_pointer(struct Arm7* cpu, unsigned int address);
+
+unsigned int arm7_read(struct Arm7* cpu, unsigned int address, int size);
+void arm7_write(struct Arm7* cpu, unsigned int address, unsigned int value, int size);
+
+// Cycles of one access of size bytes at address
+int arm7_access_cycles(struct Arm7* cpu, unsigned int address, int size, int sequential);
+
+// Start executing at address (bit 0 set for Thumb code)
+void arm7_jump(struct Arm7* cpu, unsigned int address);
+
+// Address of the next instruction
+unsigned int arm7_pc(struct Arm7* cpu);
+
+// Run one instruction and return the cycles it took (0 once stopped)
+int arm7_step(struct Arm7* cpu);
+
+// Call the function at address (bit 0 set for Thumb) with up to 4 arguments,
+// running at most max_instructions; returns r0
+unsigned int arm7_call(struct Arm7* cpu, unsigned int address, const unsigned int* args, int count,
+        unsigned long long max_instructions);
+
+#endif
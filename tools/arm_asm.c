@@ -0,0 +1,517 @@
+// Assembler for the ARM instructions of the game's .s files
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arm_asm.h"
+
+// Longest line, and most literals and loads from the pool
+#define MAX_LINE 256
+#define MAX_LITERALS 16
+#define MAX_FIXUPS 64
+
+// Condition "always", the default
+#define COND_AL 14
+
+// Data processing opcodes
+#define OP_AND 0
+#define OP_SUB 2
+#define OP_ADD 4
+#define OP_TST 8
+#define OP_CMP 10
+#define OP_CMN 11
+#define OP_MOV 13
+#define OP_BIC 14
+#define OP_MVN 15
+
+const char* const condition_names[] = {
+    "eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "al", "hs", "lo",
+};
+const int condition_codes[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 2, 3 };
+
+const char* const opcode_names[16] = {
+    "and", "eor", "sub", "rsb", "add", "adc", "sbc", "rsc",
+    "tst", "teq", "cmp", "cmn", "orr", "mov", "bic", "mvn",
+};
+
+const char* const shift_names[4] = { "lsl", "lsr", "asr", "ror" };
+
+// Words assembled so far and the literal pool that goes after them
+struct Assembly {
+    unsigned int* words;
+    int count;
+    int max;
+    unsigned int literal[MAX_LITERALS];
+    int literal_count;
+    // Word of each load from the pool, and the literal it loads
+    int fixup_word[MAX_FIXUPS];
+    int fixup_literal[MAX_FIXUPS];
+    int fixup_count;
+};
+
+void skip_blanks(const char** p) {
+    while (**p == ' ' || **p == '\t') {
+        (*p)++;
+    }
+}
+
+// Take the character c after any blanks
+int take(const char** p, char c) {
+    skip_blanks(p);
+    if (**p != c) {
+        return 0;
+    }
+    (*p)++;
+    return 1;
+}
+
+// Whether only blanks are left
+int at_end(const char** p) {
+    skip_blanks(p);
+    return **p == '\0';
+}
+
+// r0 to r15 and the other names of r10 to r15, or -1
+int parse_register(const char** p) {
+    const char* names[6] = { "sl", "fp", "ip", "sp", "lr", "pc" };
+    skip_blanks(p);
+    if ((*p)[0] == 'r' && isdigit((unsigned char) (*p)[1])) {
+        char* end;
+        long n = strtol(*p + 1, &end, 10);
+        if (n > 15 || isalnum((unsigned char) *end)) {
+            return -1;
+        }
+        *p = end;
+        return n;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (strncmp(*p, names[i], 2) == 0 && !isalnum((unsigned char) (*p)[2])) {
+            *p += 2;
+            return 10 + i;
+        }
+    }
+    return -1;
+}
+
+int parse_expression(const char** p, long long* value);
+
+// A number, a bracketed expression, or -, ~ or + before one
+int parse_factor(const char** p, long long* value) {
+    skip_blanks(p);
+    char c = **p;
+    if (c == '-' || c == '~' || c == '+') {
+        (*p)++;
+        if (!parse_factor(p, value)) {
+            return 0;
+        }
+        *value = c == '-' ? -*value : c == '~' ? ~*value : *value;
+        return 1;
+    }
+    if (c == '(') {
+        (*p)++;
+        return parse_expression(p, value) && take(p, ')');
+    }
+    if (!isdigit((unsigned char) c)) {
+        return 0;
+    }
+    char* end;
+    *value = strtoll(*p, &end, 0);
+    *p = end;
+    return 1;
+}
+
+int parse_product(const char** p, long long* value) {
+    if (!parse_factor(p, value)) {
+        return 0;
+    }
+    long long right;
+    while (take(p, '*')) {
+        if (!parse_factor(p, &right)) {
+            return 0;
+        }
+        *value *= right;
+    }
+    return 1;
+}
+
+int parse_sum(const char** p, long long* value) {
+    if (!parse_product(p, value)) {
+        return 0;
+    }
+    long long right;
+    for (;;) {
+        skip_blanks(p);
+        char c = **p;
+        if (c != '+' && c != '-') {
+            return 1;
+        }
+        (*p)++;
+        if (!parse_product(p, &right)) {
+            return 0;
+        }
+        *value = c == '+' ? *value + right : *value - right;
+    }
+}
+
+// Constant expression: numbers, brackets, + - * ~ << >>, as cpp leaves them
+int parse_expression(const char** p, long long* value) {
+    if (!parse_sum(p, value)) {
+        return 0;
+    }
+    long long right;
+    for (;;) {
+        skip_blanks(p);
+        int left = (*p)[0] == '<' && (*p)[1] == '<';
+        if (!left && !((*p)[0] == '>' && (*p)[1] == '>')) {
+            return 1;
+        }
+        *p += 2;
+        if (!parse_sum(p, &right)) {
+            return 0;
+        }
+        *value = left ? *value << right : *value >> right;
+    }
+}
+
+// Encode value as an 8-bit immediate rotated right by an even amount, with
+// the smallest rotation that fits, as GNU as picks
+int encode_immediate(unsigned int value, unsigned int* bits) {
+    for (int rotate = 0; rotate < 16; rotate++) {
+        unsigned int shift = 2 * rotate;
+        unsigned int rotated = shift ? (value << shift) | (value >> (32 - shift)) : value;
+        if (rotated <= 0xff) {
+            *bits = (rotate << 8) | rotated;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Split a mnemonic into base, condition and an optional flag letter (s or b),
+// which can come before the condition (unified syntax) or after it
+int split_mnemonic(const char* word, const char* base, char flag, int* cond, int* flagged) {
+    size_t length = strlen(base);
+    if (strncmp(word, base, length) != 0) {
+        return 0;
+    }
+    const char* rest = word + length;
+    *cond = COND_AL;
+    *flagged = 0;
+    if (flag && *rest == flag) {
+        *flagged = 1;
+        rest++;
+    }
+    if (*rest) {
+        int found = 0;
+        for (int i = 0; i < (int) (sizeof(condition_codes) / sizeof(condition_codes[0])); i++) {
+            if (strncmp(rest, condition_names[i], 2) == 0) {
+                *cond = condition_codes[i];
+                rest += 2;
+                found = 1;
+                break;
+            }
+        }
+        if (!found) {
+            return 0;
+        }
+    }
+    if (flag && !*flagged && *rest == flag) {
+        *flagged = 1;
+        rest++;
+    }
+    return *rest == '\0';
+}
+
+// Second operand of a data processing instruction: #value, rm, or rm with a
+// shift by an immediate or a register. An immediate that doesn't fit is
+// tried in the complementary instruction, the way GNU as does
+int parse_operand(const char** p, int* opcode, unsigned int* bits) {
+    long long value;
+    if (take(p, '#')) {
+        if (!parse_expression(p, &value)) {
+            return 0;
+        }
+        if (encode_immediate((unsigned int) value, bits)) {
+            *bits |= 1u << 25;
+            return 1;
+        }
+        int other = -1;
+        unsigned int alternative = 0;
+        switch (*opcode) {
+            case OP_MOV: other = OP_MVN; alternative = ~value; break;
+            case OP_MVN: other = OP_MOV; alternative = ~value; break;
+            case OP_AND: other = OP_BIC; alternative = ~value; break;
+            case OP_BIC: other = OP_AND; alternative = ~value; break;
+            case OP_CMP: other = OP_CMN; alternative = -value; break;
+            case OP_CMN: other = OP_CMP; alternative = -value; break;
+            case OP_ADD: other = OP_SUB; alternative = -value; break;
+            case OP_SUB: other = OP_ADD; alternative = -value; break;
+        }
+        if (other < 0 || !encode_immediate(alternative, bits)) {
+            return 0;
+        }
+        *opcode = other;
+        *bits |= 1u << 25;
+        return 1;
+    }
+
+    int rm = parse_register(p);
+    if (rm < 0) {
+        return 0;
+    }
+    *bits = rm;
+    if (!take(p, ',')) {
+        return 1;
+    }
+    skip_blanks(p);
+    if (strncmp(*p, "rrx", 3) == 0) {
+        *p += 3;
+        *bits |= 3 << 5;
+        return 1;
+    }
+    int type = -1;
+    for (int i = 0; i < 4; i++) {
+        if (strncmp(*p, shift_names[i], 3) == 0) {
+            type = i;
+        }
+    }
+    if (type < 0) {
+        return 0;
+    }
+    *p += 3;
+    *bits |= type << 5;
+    if (!take(p, '#')) {
+        int rs = parse_register(p);
+        if (rs < 0) {
+            return 0;
+        }
+        *bits |= (rs << 8) | (1 << 4);
+        return 1;
+    }
+    if (!parse_expression(p, &value)) {
+        return 0;
+    }
+    // lsr and asr by 32 are encoded as 0; lsl by 0 is the plain register
+    if (value == 32 && (type == 1 || type == 2)) {
+        value = 0;
+    } else if (value < (type == 0 ? 0 : 1) || value > 31) {
+        return 0;
+    }
+    *bits |= value << 7;
+    return 1;
+}
+
+int data_processing(const char** p, int opcode, int cond, int s, unsigned int* word) {
+    int rd = 0, rn = 0;
+    if (opcode >= OP_TST && opcode <= OP_CMN) {
+        s = 1;
+        rn = parse_register(p);
+    } else if (opcode == OP_MOV || opcode == OP_MVN) {
+        rd = parse_register(p);
+    } else {
+        rd = parse_register(p);
+        if (!take(p, ',')) {
+            return 0;
+        }
+        rn = parse_register(p);
+    }
+    unsigned int bits;
+    if (rd < 0 || rn < 0 || !take(p, ',') || !parse_operand(p, &opcode, &bits)) {
+        return 0;
+    }
+    *word = ((unsigned int) cond << 28) | (opcode << 21) | (s << 20) | (rn << 16) | (rd << 12) | bits;
+    return 1;
+}
+
+// mul rd, rm, rs and mla rd, rm, rs, rn
+int multiply(const char** p, int accumulate, int cond, int s, unsigned int* word) {
+    int rd = parse_register(p);
+    int rm = take(p, ',') ? parse_register(p) : -1;
+    int rs = take(p, ',') ? parse_register(p) : -1;
+    int rn = 0;
+    if (accumulate) {
+        rn = take(p, ',') ? parse_register(p) : -1;
+    }
+    if (rd < 0 || rm < 0 || rs < 0 || rn < 0) {
+        return 0;
+    }
+    *word = ((unsigned int) cond << 28) | (accumulate << 21) | (s << 20) | (rd << 16) | (rn << 12) | (rs << 8) | 0x90 | rm;
+    return 1;
+}
+
+// ldr and str with [rn] or [rn, #offset], and ldr rd, =value
+int load_store(const char** p, int load, int cond, int byte, struct Assembly* assembly, unsigned int* word) {
+    int rd = parse_register(p);
+    if (rd < 0 || !take(p, ',')) {
+        return 0;
+    }
+    long long value = 0;
+    if (load && !byte && take(p, '=')) {
+        if (!parse_expression(p, &value)) {
+            return 0;
+        }
+        unsigned int bits;
+        if (encode_immediate((unsigned int) value, &bits)) {
+            *word = ((unsigned int) cond << 28) | (1u << 25) | (OP_MOV << 21) | (rd << 12) | bits;
+            return 1;
+        }
+        if (encode_immediate(~(unsigned int) value, &bits)) {
+            *word = ((unsigned int) cond << 28) | (1u << 25) | (OP_MVN << 21) | (rd << 12) | bits;
+            return 1;
+        }
+        int literal = 0;
+        while (literal < assembly->literal_count && assembly->literal[literal] != (unsigned int) value) {
+            literal++;
+        }
+        if (literal == assembly->literal_count) {
+            if (literal == MAX_LITERALS) {
+                return 0;
+            }
+            assembly->literal[assembly->literal_count++] = (unsigned int) value;
+        }
+        if (assembly->fixup_count == MAX_FIXUPS) {
+            return 0;
+        }
+        assembly->fixup_word[assembly->fixup_count] = assembly->count;
+        assembly->fixup_literal[assembly->fixup_count++] = literal;
+        // ldr rd, [pc, #offset], the offset filled in with the pool
+        *word = ((unsigned int) cond << 28) | 0x059f0000 | (rd << 12);
+        return 1;
+    }
+
+    if (!take(p, '[')) {
+        return 0;
+    }
+    int rn = parse_register(p);
+    if (rn < 0) {
+        return 0;
+    }
+    if (take(p, ',') && (!take(p, '#') || !parse_expression(p, &value))) {
+        return 0;
+    }
+    if (!take(p, ']')) {
+        return 0;
+    }
+    int writeback = take(p, '!');
+    int up = value >= 0;
+    long long offset = up ? value : -value;
+    if (offset > 0xfff) {
+        return 0;
+    }
+    *word = ((unsigned int) cond << 28) | (1u << 26) | (1u << 24) | (up << 23) | (byte << 22) | (writeback << 21)
+            | (load << 20) | (rn << 16) | (rd << 12) | (unsigned int) offset;
+    return 1;
+}
+
+// Assemble one line (lowercase, comment removed); labels and directives
+// give no words
+int assemble_line(const char* line, struct Assembly* assembly) {
+    const char* p = line;
+    skip_blanks(&p);
+    const char* end = p;
+    while (isalnum((unsigned char) *end) || *end == '_' || *end == '.' || *end == '$') {
+        end++;
+    }
+    if (*end == ':' && end > p) {
+        p = end + 1;
+        skip_blanks(&p);
+    }
+    if (*p == '\0' || *p == '.') {
+        return 1;
+    }
+
+    char mnemonic[16];
+    int length = 0;
+    while (isalpha((unsigned char) *p) && length < 15) {
+        mnemonic[length++] = *p++;
+    }
+    mnemonic[length] = '\0';
+    if (assembly->count == assembly->max) {
+        return 0;
+    }
+
+    unsigned int word;
+    int cond, flag, done = 0;
+    for (int opcode = 0; opcode < 16 && !done; opcode++) {
+        if (split_mnemonic(mnemonic, opcode_names[opcode], 's', &cond, &flag)) {
+            done = data_processing(&p, opcode, cond, flag, &word) ? 1 : -1;
+        }
+    }
+    if (!done && split_mnemonic(mnemonic, "mul", 's', &cond, &flag)) {
+        done = multiply(&p, 0, cond, flag, &word) ? 1 : -1;
+    } else if (!done && split_mnemonic(mnemonic, "mla", 's', &cond, &flag)) {
+        done = multiply(&p, 1, cond, flag, &word) ? 1 : -1;
+    } else if (!done && split_mnemonic(mnemonic, "ldr", 'b', &cond, &flag)) {
+        done = load_store(&p, 1, cond, flag, assembly, &word) ? 1 : -1;
+    } else if (!done && split_mnemonic(mnemonic, "str", 'b', &cond, &flag)) {
+        done = load_store(&p, 0, cond, flag, assembly, &word) ? 1 : -1;
+    } else if (!done && split_mnemonic(mnemonic, "bx", 0, &cond, &flag)) {
+        int rm = parse_register(&p);
+        word = ((unsigned int) cond << 28) | 0x012fff10 | rm;
+        done = rm >= 0 ? 1 : -1;
+    }
+    if (done != 1 || !at_end(&p)) {
+        return 0;
+    }
+    assembly->words[assembly->count++] = word;
+    return 1;
+}
+
+int arm_asm(const char* source, unsigned int* words, int max, int* error_line) {
+    struct Assembly assembly;
+    memset(&assembly, 0, sizeof(assembly));
+    assembly.words = words;
+    assembly.max = max;
+
+    int line_number = 0;
+    const char* start = source;
+    while (*start) {
+        const char* end = strchr(start, '\n');
+        if (!end) {
+            end = start + strlen(start);
+        }
+        line_number++;
+
+        char line[MAX_LINE];
+        int length = end - start < MAX_LINE - 1 ? end - start : MAX_LINE - 1;
+        for (int i = 0; i < length; i++) {
+            line[i] = tolower((unsigned char) start[i]);
+        }
+        line[length] = '\0';
+        char* comment = strchr(line, '@');
+        if (comment) {
+            *comment = '\0';
+        }
+        start = *end ? end + 1 : end;
+
+        // cpp line markers (# line "file") keep the numbers those of the .s file
+        const char* p = line;
+        skip_blanks(&p);
+        if (*p == '#') {
+            p++;
+            skip_blanks(&p);
+            line_number = atoi(p) - 1;
+            continue;
+        }
+        if (!assemble_line(line, &assembly)) {
+            *error_line = line_number;
+            return -1;
+        }
+    }
+
+    // The literal pool goes after the code; pc reads 8 bytes ahead
+    if (assembly.count + assembly.literal_count > max) {
+        *error_line = line_number;
+        return -1;
+    }
+    for (int i = 0; i < assembly.fixup_count; i++) {
+        int word = assembly.fixup_word[i];
+        int offset = 4 * (assembly.count + assembly.fixup_literal[i]) - (4 * word + 8);
+        words[word] |= offset;
+    }
+    for (int i = 0; i < assembly.literal_count; i++) {
+        words[assembly.count + i] = assembly.literal[i];
+    }
+    return assembly.count + assembly.literal_count;
+}
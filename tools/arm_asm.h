@@ -0,0 +1,23 @@
+#ifndef ARM_ASM_H
+#define ARM_ASM_H
+
+/*
+ * Assembler for the ARM instructions the game's .s files use, so the
+ * hand-assembled copies in asm_image.c can be checked against the source
+ * without an ARM toolchain.
+ *
+ * It reads a .s file after the C preprocessor and encodes the way GNU as
+ * does: data processing with a rotated immediate (the smallest rotation) or
+ * a register shifted by an immediate, mul, ldr and str with an immediate
+ * offset, ldr rd, =value (a mov or mvn when the value fits, otherwise a load
+ * from a literal pool after the code) and bx. Labels, directives and @
+ * comments are skipped. Anything else is an error, so an instruction added
+ * to a .s file has to be added here too before the check passes.
+ */
+
+// Assemble source into at most max words, the literal pool included.
+// Returns the number of words, or -1 with the number of the line that could
+// not be assembled in *error_line
+int arm_asm(const char* source, unsigned int* words, int max, int* error_line);
+
+#endif
@@ -0,0 +1,642 @@
+// Cycle counts for the game's code on a host, from the ARM7TDMI interpreter
+// in arm7.c.
+//
+// With no ROM it runs getIndex.s and updateLanderXvel.s from asm_image.c,
+// from IWRAM and from ROM, and checks every result against the C versions in
+// asm_fallback.c. The code is taken out of the assembled objects when there is
+// an ARM toolchain; otherwise the built-in copies are run, and a copy that
+// doesn't match its .s file is an error too:
+//
+//   armsim
+//
+// Given the ELF file of a ROM build, it boots the ROM and runs the frame loop,
+// reporting the busy cycles of each frame and a flat profile by function, or
+// calls a single function with integer arguments:
+//
+//   armsim [-f frames] [-b seed] [-w waitcnt] build/lander.elf
+//   armsim [-w waitcnt] -c function build/lander.elf [args ...]
+//
+// Only the CPU is modelled. The BIOS calls the game makes (VBlankIntrWait,
+// CpuFastSet and the decompressors), DMA 3, the timers, VCOUNT and the keys
+// are stood in for by the host, with rough cycle counts for the BIOS calls.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <elf.h>
+
+#include "arm7.h"
+#include "asm_image.h"
+#include "hal.h"
+#include "game.h"
+#include "fixed.h"
+#include "physics.h"
+
+// Cycles per scanline and the first line of vblank
+#define CYCLES_PER_LINE 1232
+#define VBLANK_LINE 160
+
+// Where the BIOS keeps the interrupt handler and its copy of the flags
+#define BIOS_IRQ_HANDLER 0x03007ffc
+#define BIOS_IRQ_FLAGS 0x03007ff8
+
+// Instructions a call may take before it is given up on
+#define MAX_CALL_INSTRUCTIONS 100000000ULL
+
+// I/O registers stood in for
+#define IO_DISPSTAT 0x004
+#define IO_VCOUNT 0x006
+#define IO_DMA3 0x0d4
+#define IO_TIMER0 0x100
+#define IO_TIMER1 0x104
+#define IO_KEYINPUT 0x130
+#define IO_IE 0x200
+#define IO_IF 0x202
+#define IO_WAITCNT 0x204
+#define IO_IME 0x208
+
+// State of the hardware around the CPU
+struct Machine {
+    int in_vblank_wait; // the game is waiting for the next frame
+    unsigned long long timer_start; // cycle count when the cycle counter started
+    int timer_running;
+    unsigned short keys; // BUTTON_* bits held this frame
+};
+
+// A function symbol from the ELF file
+struct Symbol {
+    const char* name;
+    unsigned int start, end;
+    unsigned long long cycles;
+    unsigned long long calls;
+};
+
+unsigned int io16(struct Arm7* cpu, unsigned int offset) {
+    unsigned char* p = cpu->memory[0x04] + offset;
+    return p[0] | (p[1] << 8);
+}
+
+void set_io16(struct Arm7* cpu, unsigned int offset, unsigned int value) {
+    unsigned char* p = cpu->memory[0x04] + offset;
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+// Bring a register up to date before the game reads it
+void machine_io_read(struct Arm7* cpu, unsigned int offset) {
+    struct Machine* machine = cpu->user;
+    int line = (int) ((cpu->cycles / CYCLES_PER_LINE) % 228);
+
+    switch (offset & ~1u) {
+    case IO_VCOUNT:
+        set_io16(cpu, IO_VCOUNT, line);
+        break;
+    case IO_DISPSTAT:
+        set_io16(cpu, IO_DISPSTAT, (io16(cpu, IO_DISPSTAT) & ~1u) | (line >= VBLANK_LINE && line < 227));
+        break;
+    case IO_TIMER0:
+    case IO_TIMER1:
+        // Timer 0 counts every cycle and timer 1 counts its overflows
+        if (machine->timer_running) {
+            unsigned long long elapsed = cpu->cycles - machine->timer_start;
+            set_io16(cpu, IO_TIMER0, elapsed & 0xffff);
+            set_io16(cpu, IO_TIMER1, (elapsed >> 16) & 0xffff);
+        }
+        break;
+    case IO_KEYINPUT:
+        set_io16(cpu, IO_KEYINPUT, ~machine->keys & BUTTON_MASK);
+        break;
+    }
+}
+
+// Whether a write of size bytes at offset touched the register at reg
+int wrote(unsigned int offset, int size, unsigned int reg) {
+    return offset <= reg && reg < offset + size;
+}
+
+// Do a DMA 3 transfer the moment it is enabled
+void machine_dma3(struct Arm7* cpu) {
+    unsigned int control = io16(cpu, IO_DMA3 + 10);
+    if (!(control & 0x8000)) {
+        return;
+    }
+    unsigned int source = io16(cpu, IO_DMA3) | (io16(cpu, IO_DMA3 + 2) << 16);
+    unsigned int dest = io16(cpu, IO_DMA3 + 4) | (io16(cpu, IO_DMA3 + 6) << 16);
+    int count = io16(cpu, IO_DMA3 + 8);
+    int size = (control & 0x0400) ? 4 : 2;
+    int dest_mode = (control >> 5) & 3, source_mode = (control >> 7) & 3;
+    if (count == 0) {
+        count = 0x4000;
+    }
+
+    // 2N + 2(n-1)S + 2I
+    cpu->cycles += 2;
+    for (int i = 0; i < count; i++) {
+        cpu->cycles += arm7_access_cycles(cpu, source, size, i > 0) + arm7_access_cycles(cpu, dest, size, i > 0);
+        arm7_write(cpu, dest, arm7_read(cpu, source, size), size);
+        source += source_mode == 0 ? size : source_mode == 1 ? -size : 0;
+        dest += (dest_mode == 0 || dest_mode == 3) ? size : dest_mode == 1 ? -size : 0;
+    }
+    set_io16(cpu, IO_DMA3 + 10, control & 0x7fff);
+}
+
+void machine_io_write(struct Arm7* cpu, unsigned int offset, int size) {
+    struct Machine* machine = cpu->user;
+
+    if (wrote(offset, size, IO_DMA3 + 10)) {
+        machine_dma3(cpu);
+    }
+    if (wrote(offset, size, IO_TIMER0 + 2)) {
+        int running = (io16(cpu, IO_TIMER0 + 2) & TIMER_ENABLE) != 0;
+        if (running && !machine->timer_running) {
+            machine->timer_start = cpu->cycles;
+        }
+        machine->timer_running = running;
+    }
+    if (wrote(offset, size, IO_WAITCNT)) {
+        arm7_set_waitcnt(cpu, io16(cpu, IO_WAITCNT));
+    }
+}
+
+// BIOS calls
+void machine_swi(struct Arm7* cpu, int number) {
+    struct Machine* machine = cpu->user;
+    unsigned int source = cpu->r[0], dest = cpu->r[1];
+
+    switch (number) {
+    case 0x05:
+        // VBlankIntrWait: stop and let the frame loop take over
+        machine->in_vblank_wait = 1;
+        cpu->stopped = 1;
+        break;
+    case 0x0c: {
+        // CpuFastSet: blocks of 8 words with LDMIA/STMIA
+        unsigned int* s = (unsigned int*) arm7_pointer(cpu, source);
+        unsigned int* d = (unsigned int*) arm7_pointer(cpu, dest);
+        int words = ((cpu->r[2] & 0x1fffff) + 7) & ~7;
+        if (!s || !d) {
+            cpu->error = "CpuFastSet outside memory";
+            cpu->stopped = 1;
+            break;
+        }
+        hal_cpu_fast_set(s, d, cpu->r[2]);
+        cpu->cycles += words * (arm7_access_cycles(cpu, source, 4, 1) + arm7_access_cycles(cpu, dest, 4, 1));
+        break;
+    }
+    case 0x12:
+    case 0x15: {
+        // LZ77UnCompVram and RLUnCompVram, at a rough 8 cycles per byte out
+        unsigned char* s = arm7_pointer(cpu, source);
+        unsigned char* d = arm7_pointer(cpu, dest);
+        if (!s || !d) {
+            cpu->error = "decompression outside memory";
+            cpu->stopped = 1;
+            break;
+        }
+        if (number == 0x12) {
+            hal_lz77_uncomp_vram(s, d);
+        } else {
+            hal_rl_uncomp_vram(s, d);
+        }
+        cpu->cycles += 8 * (s[1] | (s[2] << 8) | (s[3] << 16));
+        break;
+    }
+    default:
+        cpu->error = "unsupported BIOS call";
+        cpu->stopped = 1;
+        break;
+    }
+}
+
+void machine_init(struct Arm7* cpu, struct Machine* machine, unsigned int rom_size) {
+    arm7_init(cpu, rom_size);
+    memset(machine, 0, sizeof(*machine));
+    cpu->user = machine;
+    cpu->io_read = machine_io_read;
+    cpu->io_write = machine_io_write;
+    cpu->swi = machine_swi;
+    set_io16(cpu, IO_KEYINPUT, BUTTON_MASK);
+}
+
+//
+// Built-in image
+//
+
+// Timing of one routine over a set of calls
+struct Timing {
+    unsigned long long total;
+    unsigned int min, max;
+    int calls;
+    int wrong;
+};
+
+void timing_add(struct Timing* timing, unsigned int cycles) {
+    if (timing->calls == 0 || cycles < timing->min) {
+        timing->min = cycles;
+    }
+    if (cycles > timing->max) {
+        timing->max = cycles;
+    }
+    timing->total += cycles;
+    timing->calls++;
+}
+
+void timing_print(const char* name, const char* where, const struct Timing* timing) {
+    printf("%-28s %-6s %8.2f %6u %6u %8d  %s\n", name, where, (double) timing->total / timing->calls,
+            timing->min, timing->max, timing->calls, timing->wrong ? "WRONG" : "ok");
+}
+
+// Time getIndex at an address against the C version
+void time_get_index(struct Arm7* cpu, unsigned int address, struct Timing* timing) {
+    unsigned int seed = 1;
+    memset(timing, 0, sizeof(*timing));
+    for (int i = 0; i < 10000; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        // Negative and out-of-map pixels too
+        int x = (int) (seed & 0x3ff) - 256, y = (int) ((seed >> 10) & 0x3ff) - 256;
+        unsigned int args[2] = { x, y };
+
+        unsigned long long start = cpu->cycles;
+        int index = (int) arm7_call(cpu, address, args, 2, MAX_CALL_INSTRUCTIONS);
+        timing_add(timing, cpu->cycles - start);
+        if (index != getIndex(x, y)) {
+            timing->wrong++;
+        }
+    }
+}
+
+// Time updateLanderXvel at an address against the C version
+void time_update_lander_xvel(struct Arm7* cpu, unsigned int address, struct Timing* timing) {
+    memset(timing, 0, sizeof(*timing));
+    for (int fuel_start = 1; fuel_start <= 0x3000; fuel_start = bcd_add(fuel_start, 1)) {
+        int right = fuel_start & 1;
+        // from across the whole 8.8 range, and every other call from near the
+        // limit it moves towards, where it saturates
+        int xvel_start = ((fuel_start * 97) & 0xffff) + FIXED8_MIN;
+        if (fuel_start & 2) {
+            xvel_start = right ? FIXED8_MAX - (fuel_start & 63) : FIXED8_MIN + (fuel_start & 63);
+        }
+        int xvel = xvel_start, fuel = fuel_start;
+        int thrust = right ? LANDER_RCS : -LANDER_RCS;
+        updateLanderXvel(&xvel, thrust, &fuel);
+
+        arm7_write(cpu, IMAGE_DATA, xvel_start, 4);
+        arm7_write(cpu, IMAGE_DATA + 4, fuel_start, 4);
+        unsigned int args[3] = { IMAGE_DATA, (unsigned int) thrust, IMAGE_DATA + 4 };
+        unsigned long long start = cpu->cycles;
+        arm7_call(cpu, address, args, 3, MAX_CALL_INSTRUCTIONS);
+        timing_add(timing, cpu->cycles - start);
+
+        if ((int) arm7_read(cpu, IMAGE_DATA, 4) != xvel || (int) arm7_read(cpu, IMAGE_DATA + 4, 4) != fuel) {
+            timing->wrong++;
+        }
+    }
+}
+
+int run_builtin(unsigned int waitcnt) {
+    struct Arm7 cpu;
+    struct Machine machine;
+    machine_init(&cpu, &machine, IMAGE_ROM_SIZE);
+    arm7_set_waitcnt(&cpu, waitcnt);
+
+    int wrong = asm_image_load(&cpu);
+
+    printf("%s, WAITCNT 0x%04x; cycles per call including the return\n",
+            asm_image_assembled ? "assembled image" : "built-in image", waitcnt);
+    printf("%-28s %-6s %8s %6s %6s %8s  %s\n", "function", "where", "average", "min", "max", "calls", "result");
+
+    struct Timing timing;
+    time_get_index(&cpu, IMAGE_GET_INDEX_IWRAM, &timing);
+    timing_print("getIndex.s (ARM)", "IWRAM", &timing);
+    wrong += timing.wrong;
+    time_get_index(&cpu, IMAGE_GET_INDEX_ROM, &timing);
+    timing_print("getIndex.s (ARM)", "ROM", &timing);
+    wrong += timing.wrong;
+    time_get_index(&cpu, IMAGE_GET_INDEX_THUMB, &timing);
+    timing_print("getIndex (Thumb)", "ROM", &timing);
+    wrong += timing.wrong;
+    time_update_lander_xvel(&cpu, IMAGE_UPDATE_LANDER_XVEL_ROM, &timing);
+    timing_print("updateLanderXvel.s (ARM)", "ROM", &timing);
+    wrong += timing.wrong;
+    time_update_lander_xvel(&cpu, IMAGE_UPDATE_LANDER_XVEL_IWRAM, &timing);
+    timing_print("updateLanderXvel.s (ARM)", "IWRAM", &timing);
+    wrong += timing.wrong;
+
+    if (cpu.error) {
+        printf("stopped: %s at 0x%08x\n", cpu.error, arm7_pc(&cpu));
+        wrong++;
+    }
+    arm7_free(&cpu);
+    return wrong ? 1 : 0;
+}
+
+//
+// ELF files
+//
+
+// Function symbols of a loaded ELF file, sorted by address
+struct Symbol* symbols;
+int symbol_count;
+
+int compare_symbols(const void* a, const void* b) {
+    const struct Symbol* x = a;
+    const struct Symbol* y = b;
+    return x->start < y->start ? -1 : x->start > y->start;
+}
+
+// Load the segments of an ELF file at both their load and run addresses, so
+// IWRAM code is in place even before crt0.s copies it; returns the entry
+int load_elf(struct Arm7* cpu, struct Machine* machine, const char* path, unsigned int* entry) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = malloc(size);
+    if (fread(data, 1, size, file) != (size_t) size) {
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+
+    Elf32_Ehdr* header = (Elf32_Ehdr*) data;
+    if (size < (long) sizeof(*header) || memcmp(header->e_ident, ELFMAG, SELFMAG) != 0
+            || header->e_ident[EI_CLASS] != ELFCLASS32 || header->e_machine != EM_ARM) {
+        fprintf(stderr, "%s: not a 32-bit ARM ELF file\n", path);
+        return 0;
+    }
+
+    // The ROM is as big as the highest segment loaded into it
+    unsigned int rom_size = 0x100;
+    Elf32_Phdr* segments = (Elf32_Phdr*) (data + header->e_phoff);
+    for (int i = 0; i < header->e_phnum; i++) {
+        if (segments[i].p_type == PT_LOAD && (segments[i].p_paddr >> 24) >= 0x08) {
+            unsigned int end = (segments[i].p_paddr & 0x01ffffff) + segments[i].p_memsz;
+            rom_size = end > rom_size ? end : rom_size;
+        }
+    }
+    machine_init(cpu, machine, rom_size);
+
+    for (int i = 0; i < header->e_phnum; i++) {
+        Elf32_Phdr* segment = &segments[i];
+        if (segment->p_type != PT_LOAD || segment->p_filesz == 0) {
+            continue;
+        }
+        unsigned int addresses[2] = { segment->p_paddr, segment->p_vaddr };
+        for (int j = 0; j < 2; j++) {
+            unsigned char* p = arm7_pointer(cpu, addresses[j]);
+            if (p) {
+                memcpy(p, data + segment->p_offset, segment->p_filesz);
+            }
+        }
+    }
+
+    // Function symbols, for the profile and for -c
+    Elf32_Shdr* sections = (Elf32_Shdr*) (data + header->e_shoff);
+    for (int i = 0; i < header->e_shnum; i++) {
+        if (sections[i].sh_type != SHT_SYMTAB) {
+            continue;
+        }
+        Elf32_Sym* table = (Elf32_Sym*) (data + sections[i].sh_offset);
+        const char* names = (const char*) (data + sections[sections[i].sh_link].sh_offset);
+        int count = sections[i].sh_size / sizeof(Elf32_Sym);
+        symbols = calloc(count, sizeof(struct Symbol));
+        for (int j = 0; j < count; j++) {
+            if (ELF32_ST_TYPE(table[j].st_info) != STT_FUNC || table[j].st_value == 0) {
+                continue;
+            }
+            struct Symbol* symbol = &symbols[symbol_count++];
+            symbol->name = names + table[j].st_name;
+            // Keep the Thumb bit in start, for calling
+            symbol->start = table[j].st_value;
+            symbol->end = (table[j].st_value & ~1u) + (table[j].st_size ? table[j].st_size : 2);
+        }
+    }
+    qsort(symbols, symbol_count, sizeof(struct Symbol), compare_symbols);
+
+    *entry = header->e_entry;
+    return 1;
+}
+
+// Function holding an address, found by a binary search
+struct Symbol* find_symbol(unsigned int address) {
+    int low = 0, high = symbol_count - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        struct Symbol* symbol = &symbols[middle];
+        if (address < (symbol->start & ~1u)) {
+            high = middle - 1;
+        } else if (address >= symbol->end) {
+            low = middle + 1;
+        } else {
+            return symbol;
+        }
+    }
+    return NULL;
+}
+
+// Run the handler the game installed, as the BIOS does for an interrupt
+void raise_vblank(struct Arm7* cpu) {
+    set_io16(cpu, IO_IF, io16(cpu, IO_IF) | IRQ_VBLANK);
+    unsigned int handler = arm7_read(cpu, BIOS_IRQ_HANDLER, 4);
+    if (!handler || !(io16(cpu, IO_IME) & 1) || !(io16(cpu, IO_IE) & IRQ_VBLANK)) {
+        return;
+    }
+
+    unsigned int saved[16];
+    unsigned int saved_cpsr = cpu->cpsr;
+    memcpy(saved, cpu->r, sizeof(saved));
+    // The BIOS saves r0-r3, r12 and lr on the IRQ stack before calling
+    cpu->cycles += 20;
+    arm7_call(cpu, handler & ~1u, NULL, 0, MAX_CALL_INSTRUCTIONS);
+    memcpy(cpu->r, saved, sizeof(saved));
+    cpu->cpsr = saved_cpsr;
+    // The handler acknowledged it in the BIOS flags, which VBlankIntrWait clears
+    arm7_write(cpu, BIOS_IRQ_FLAGS, 0, 2);
+}
+
+// xorshift buttons, the same scripted pilot as host_main
+unsigned short scripted_buttons(unsigned int* seed) {
+    unsigned int s = *seed;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    *seed = s;
+
+    unsigned short held = 0;
+    if ((s & 3) == 0) {
+        held |= BUTTON_A;
+    }
+    if (((s >> 8) & 15) == 0) {
+        held |= BUTTON_LEFT;
+    } else if (((s >> 8) & 15) == 1) {
+        held |= BUTTON_RIGHT;
+    } else if (((s >> 8) & 15) == 2) {
+        held |= BUTTON_L;
+    } else if (((s >> 8) & 15) == 3) {
+        held |= BUTTON_R;
+    }
+    return held;
+}
+
+int compare_cycles(const void* a, const void* b) {
+    const struct Symbol* x = a;
+    const struct Symbol* y = b;
+    return x->cycles < y->cycles ? 1 : x->cycles > y->cycles ? -1 : 0;
+}
+
+// Boot the ROM and run the frame loop
+int run_rom(const char* path, int frames, unsigned int seed, unsigned int waitcnt) {
+    struct Arm7 cpu;
+    struct Machine machine;
+    unsigned int entry;
+    if (!load_elf(&cpu, &machine, path, &entry)) {
+        return 2;
+    }
+    arm7_set_waitcnt(&cpu, waitcnt);
+    arm7_jump(&cpu, entry);
+
+    unsigned long long boot = 0, busy_total = 0, busy_min = ~0ULL, busy_max = 0, frame_start = 0;
+    unsigned long long other_cycles = 0;
+    int frame = -1, late = 0;
+    struct Symbol* current = NULL;
+
+    while (frame < frames) {
+        unsigned int pc = arm7_pc(&cpu);
+        if (!current || pc < (current->start & ~1u) || pc >= current->end) {
+            current = find_symbol(pc);
+            if (current && pc == (current->start & ~1u)) {
+                current->calls++;
+            }
+        }
+        int cycles = arm7_step(&cpu);
+        if (current) {
+            current->cycles += cycles;
+        } else {
+            other_cycles += cycles;
+        }
+
+        if (cpu.error) {
+            printf("stopped: %s at 0x%08x\n", cpu.error, pc);
+            return 1;
+        }
+        if (!machine.in_vblank_wait) {
+            continue;
+        }
+
+        // The frame's work is done: sleep to the next vblank and run the handler
+        unsigned long long busy = cpu.cycles - frame_start;
+        if (frame < 0) {
+            boot = busy;
+        } else {
+            busy_total += busy;
+            busy_min = busy < busy_min ? busy : busy_min;
+            busy_max = busy > busy_max ? busy : busy_max;
+            late += busy > CYCLES_PER_FRAME;
+        }
+        unsigned long long vblank = (cpu.cycles / CYCLES_PER_FRAME) * CYCLES_PER_FRAME + VBLANK_LINE * CYCLES_PER_LINE;
+        if (vblank <= cpu.cycles) {
+            vblank += CYCLES_PER_FRAME;
+        }
+        cpu.cycles = vblank;
+        frame_start = cpu.cycles;
+        frame++;
+
+        machine.keys = seed ? scripted_buttons(&seed) : 0;
+        machine.in_vblank_wait = 0;
+        cpu.stopped = 0;
+        raise_vblank(&cpu);
+        if (cpu.error) {
+            printf("stopped: %s in the interrupt handler\n", cpu.error);
+            return 1;
+        }
+    }
+
+    printf("%s: boot %llu cycles, %d frames\n", path, boot, frames);
+    if (frames > 0) {
+        printf("busy cycles per frame: min %llu  avg %llu  max %llu  (%.1f%% of %d on average, %d late)\n",
+                busy_min, busy_total / frames, busy_max, 100.0 * busy_total / frames / CYCLES_PER_FRAME,
+                CYCLES_PER_FRAME, late);
+    }
+
+    // Flat profile of the whole run, boot included
+    qsort(symbols, symbol_count, sizeof(struct Symbol), compare_cycles);
+    printf("%-32s %14s %7s %10s %10s\n", "function", "cycles", "%", "calls", "per call");
+    for (int i = 0; i < symbol_count && symbols[i].cycles > 0; i++) {
+        printf("%-32s %14llu %6.2f%% %10llu %10.1f\n", symbols[i].name, symbols[i].cycles,
+                100.0 * symbols[i].cycles / cpu.cycles, symbols[i].calls,
+                symbols[i].calls ? (double) symbols[i].cycles / symbols[i].calls : 0.0);
+    }
+    if (other_cycles) {
+        printf("%-32s %14llu %6.2f%%\n", "(outside functions)", other_cycles, 100.0 * other_cycles / cpu.cycles);
+    }
+    arm7_free(&cpu);
+    return 0;
+}
+
+// Call one function of the ROM with integer arguments
+int run_call(const char* path, const char* name, char** args, int count, unsigned int waitcnt) {
+    struct Arm7 cpu;
+    struct Machine machine;
+    unsigned int entry;
+    if (!load_elf(&cpu, &machine, path, &entry)) {
+        return 2;
+    }
+    arm7_set_waitcnt(&cpu, waitcnt);
+
+    for (int i = 0; i < symbol_count; i++) {
+        if (strcmp(symbols[i].name, name) != 0) {
+            continue;
+        }
+        unsigned int values[4] = { 0 };
+        for (int j = 0; j < count && j < 4; j++) {
+            values[j] = (unsigned int) strtol(args[j], NULL, 0);
+        }
+        unsigned int result = arm7_call(&cpu, symbols[i].start, values, count, MAX_CALL_INSTRUCTIONS);
+        if (cpu.error) {
+            printf("stopped: %s at 0x%08x\n", cpu.error, arm7_pc(&cpu));
+            return 1;
+        }
+        printf("%s at 0x%08x: returned %d (0x%x) in %llu cycles, %llu instructions\n", name,
+                symbols[i].start & ~1u, (int) result, result, cpu.cycles, cpu.instructions);
+        return 0;
+    }
+    fprintf(stderr, "%s: no function %s\n", path, name);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    unsigned int seed = 0;
+    unsigned int waitcnt = 0;
+    const char* call = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "f:b:w:c:")) != -1) {
+        switch (option) {
+        case 'f': frames = atoi(optarg); break;
+        case 'b': seed = (unsigned int) strtoul(optarg, NULL, 0); break;
+        case 'w': waitcnt = (unsigned int) strtoul(optarg, NULL, 0); break;
+        case 'c': call = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-w waitcnt]\n"
+                    "       %s [-f frames] [-b seed] [-w waitcnt] rom.elf\n"
+                    "       %s [-w waitcnt] -c function rom.elf [args ...]\n", argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind == argc) {
+        return run_builtin(waitcnt);
+    }
+    if (call) {
+        return run_call(argv[optind], call, argv + optind + 1, argc - optind - 1, waitcnt);
+    }
+    return run_rom(argv[optind], frames, seed, waitcnt);
+}
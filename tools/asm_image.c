@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "arm_asm.h"
+#include "asm_image.h"
+
+// Largest routine and preprocessed .s file
+#define IMAGE_MAX_WORDS 64
+#define IMAGE_MAX_SOURCE 0x4000
+
+// getIndex.s, ARM
+const unsigned int get_index_arm[] = {
+    0xe20000ff, // and r0, r0, #255
+    0xe20110ff, // and r1, r1, #255
+    0xe1a001c0, // mov r0, r0, asr #3
+    0xe1a011c1, // mov r1, r1, asr #3
+    0xe3a02020, // mov r2, #32
+    0xe0010192, // mul r1, r2, r1
+    0xe0800001, // add r0, r0, r1
+    0xe12fff1e, // bx lr
+};
+
+// getIndex as Thumb, the way GCC compiles the C version
+const unsigned short get_index_thumb[] = {
+    0x0600, // lsl r0, r0, #24
+    0x0ec0, // lsr r0, r0, #27
+    0x0609, // lsl r1, r1, #24
+    0x0ec9, // lsr r1, r1, #27
+    0x0149, // lsl r1, r1, #5
+    0x1840, // add r0, r0, r1
+    0x4770, // bx lr
+};
+
+// updateLanderXvel.s, ARM
+const unsigned int update_lander_xvel_arm[] = {
+    0xe5903000, // ldr r3, [r0]
+    0xe0833001, // add r3, r3, r1
+    0xe3530902, // cmp r3, #0x8000
+    0xa3a03c7f, // movge r3, #0x7f00
+    0xa38330ff, // orrge r3, r3, #0xff
+    0xe3730902, // cmn r3, #0x8000
+    0xb3e03c7f, // mvnlt r3, #0x7f00
+    0xb3c330ff, // biclt r3, r3, #0xff
+    0xe5803000, // str r3, [r0]
+    0xe5923000, // ldr r3, [r2]
+    0xe2431001, // sub r1, r3, #1
+    0xe0233001, // eor r3, r3, r1
+    0xe59f0010, // ldr r0, =0x01111111
+    0xe0003223, // and r3, r0, r3, lsr #4
+    0xe0833083, // add r3, r3, r3, lsl #1
+    0xe0411083, // sub r1, r1, r3, lsl #1
+    0xe5821000, // str r1, [r2]
+    0xe12fff1e, // bx lr
+    0x01111111, // literal pool
+};
+
+// A routine, the files it is taken from or checked against, and where it goes
+struct Routine {
+    const char* name;
+    const void* copy;
+    int size;
+    const char* assembled;
+    const char* source;
+    unsigned int address[2];
+};
+
+const struct Routine routines[] = {
+    { "getIndex.s", get_index_arm, sizeof(get_index_arm), ASM_IMAGE_DIR "asm/getIndex.bin",
+            ASM_IMAGE_DIR "host/getIndex.i", { IMAGE_GET_INDEX_IWRAM, IMAGE_GET_INDEX_ROM } },
+    { "updateLanderXvel.s", update_lander_xvel_arm, sizeof(update_lander_xvel_arm),
+            ASM_IMAGE_DIR "asm/updateLanderXvel.bin", ASM_IMAGE_DIR "host/updateLanderXvel.i",
+            { IMAGE_UPDATE_LANDER_XVEL_IWRAM, IMAGE_UPDATE_LANDER_XVEL_ROM } },
+    { "getIndex (Thumb)", get_index_thumb, sizeof(get_index_thumb), ASM_IMAGE_DIR "asm/getIndex_thumb.bin",
+            NULL, { IMAGE_GET_INDEX_THUMB, 0 } },
+};
+
+int asm_image_assembled;
+
+// Read up to size bytes of a file; returns the length, or -1
+int read_file(const char* path, void* buffer, int size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    int length = fread(buffer, 1, size, file);
+    fclose(file);
+    return length;
+}
+
+// Check a copy against its .s file; returns 0 when they match
+int check_copy(const struct Routine* routine) {
+    char source[IMAGE_MAX_SOURCE];
+    int length = read_file(routine->source, source, sizeof(source) - 1);
+    if (length < 0) {
+        fprintf(stderr, "%s: cannot read %s to check the built-in copy\n", routine->name, routine->source);
+        return 1;
+    }
+    source[length] = '\0';
+
+    unsigned int words[IMAGE_MAX_WORDS];
+    int line;
+    int count = arm_asm(source, words, IMAGE_MAX_WORDS, &line);
+    if (count < 0) {
+        fprintf(stderr, "%s:%d: cannot assemble this to check the built-in copy\n", routine->name, line);
+        return 1;
+    }
+    const unsigned int* copy = routine->copy;
+    int copy_count = routine->size / 4;
+    for (int i = 0; i < count || i < copy_count; i++) {
+        if (i >= count || i >= copy_count || words[i] != copy[i]) {
+            fprintf(stderr, "%s: the built-in copy differs from the source at word %d (%08x, should be %08x)\n",
+                    routine->name, i, i < copy_count ? copy[i] : 0, i < count ? words[i] : 0);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Copy code to an address
+void asm_image_put(struct Arm7* cpu, unsigned int address, const void* code, int size) {
+    memcpy(arm7_pointer(cpu, address & ~1u), code, size);
+}
+
+int asm_image_load(struct Arm7* cpu) {
+    int problems = 0;
+    asm_image_assembled = 0;
+    for (int i = 0; i < (int) (sizeof(routines) / sizeof(routines[0])); i++) {
+        const struct Routine* routine = &routines[i];
+        unsigned int code[IMAGE_MAX_WORDS];
+        int size = read_file(routine->assembled, code, sizeof(code));
+        if (size > 0) {
+            asm_image_assembled++;
+        } else {
+            memcpy(code, routine->copy, routine->size);
+            size = routine->size;
+            problems += routine->source ? check_copy(routine) : 0;
+        }
+        for (int j = 0; j < 2 && routine->address[j]; j++) {
+            asm_image_put(cpu, routine->address[j], code, size);
+        }
+    }
+    return problems;
+}
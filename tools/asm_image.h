@@ -0,0 +1,47 @@
+#ifndef ASM_IMAGE_H
+#define ASM_IMAGE_H
+
+/*
+ * getIndex.s and updateLanderXvel.s for timing them in the ARM7TDMI
+ * interpreter, along with a Thumb getIndex as GCC compiles the C version.
+ *
+ * With an ARM toolchain the Makefile takes the code out of the assembled
+ * objects into build/asm, and asm_image_load runs that. Without one it runs
+ * hand-assembled copies, after checking them against what arm_asm makes of
+ * the .s files (put through the C preprocessor into build/host), so a copy
+ * that has fallen behind its .s file is reported instead of timed. The
+ * Thumb copy is compiler output with no source to check it against.
+ *
+ * The code is position independent, so each routine goes both in IWRAM and
+ * in ROM.
+ */
+
+#include "arm7.h"
+
+// Addresses of the routines (bit 0 set for Thumb code)
+#define IMAGE_GET_INDEX_IWRAM 0x03000000
+#define IMAGE_UPDATE_LANDER_XVEL_IWRAM 0x03000100
+#define IMAGE_GET_INDEX_ROM 0x08000000
+#define IMAGE_UPDATE_LANDER_XVEL_ROM 0x08000100
+#define IMAGE_GET_INDEX_THUMB 0x08000201
+
+// Free IWRAM for the data the routines work on
+#define IMAGE_DATA 0x03004000
+
+// ROM the image needs
+#define IMAGE_ROM_SIZE 0x1000
+
+// Directory of the files made by the Makefile: build/asm/*.bin with a
+// toolchain, build/host/*.i always
+#ifndef ASM_IMAGE_DIR
+#define ASM_IMAGE_DIR "build/"
+#endif
+
+// Routines asm_image_load took from the assembled objects
+extern int asm_image_assembled;
+
+// Copy the routines into memory. Returns the number of copies that could
+// not be checked or don't match their .s file, each reported on stderr
+int asm_image_load(struct Arm7* cpu);
+
+#endif
@@ -0,0 +1,355 @@
+// Microbenchmarks of the frame-loop kernels, built from the game's own
+// sources against the HAL_HOST backend.
+//
+// Each benchmark runs a kernel in a loop. The loop length is calibrated so a
+// repetition takes about 20 ms, one repetition is thrown away as warm-up, and
+// the median, min, max and spread of the rest are reported in ns per
+// operation. The assembly routines can't run natively, so they are timed in
+// the ARM7TDMI interpreter instead and reported in GBA cycles per operation.
+//
+// The output has one line per benchmark under a fixed name, so runs from two
+// commits can be diffed, or compared directly:
+//
+//   bench [-r repetitions] [-t ms] > before.txt
+//   bench -b before.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "terrain.h"
+#include "assets.h"
+#include "input.h"
+#include "entity.h"
+#include "level.h"
+#include "physics.h"
+#include "arm7.h"
+#include "asm_image.h"
+
+// Longest benchmark name kept from a baseline file
+#define NAME_SIZE 64
+
+// Keeps results alive so the compiler can't drop the work
+volatile int bench_sink;
+
+// Game the kernels work on
+struct Game bench_game;
+
+// Inputs prepared before timing
+#define INPUTS 1024
+int bench_x[INPUTS], bench_y[INPUTS];
+
+// Loop bodies, each running a kernel ops times
+
+void bench_get_index(long ops) {
+    int sum = 0;
+    for (long i = 0; i < ops; i++) {
+        sum += getIndex(bench_x[i & (INPUTS - 1)], bench_y[i & (INPUTS - 1)]);
+    }
+    bench_sink = sum;
+}
+
+void bench_check_collision(long ops) {
+    struct Lander* lander = &bench_game.lander;
+    int sum = 0;
+    for (long i = 0; i < ops; i++) {
+        int xscroll = bench_x[i & (INPUTS - 1)], yscroll = bench_y[i & (INPUTS - 1)] & 127;
+        sum += checkCollision(lander, &xscroll, &yscroll);
+    }
+    bench_sink = sum;
+}
+
+void bench_terrain_sweep(long ops) {
+    struct TerrainContact contact;
+    int sum = 0;
+    for (long i = 0; i < ops; i++) {
+        // moves of up to 16 pixels each way, as fast as the lander falls
+        int x = bench_x[i & (INPUTS - 1)], y = bench_y[i & (INPUTS - 1)];
+        terrain_sweep(x, 256 + (y & 255), x + 7, 263 + (y & 255), (y & 31) - 16, (x & 31) - 16, sprites_mask, &contact);
+        sum += contact.dy;
+    }
+    bench_sink = sum;
+}
+
+void bench_sprite_position(long ops) {
+    struct Sprite* sprite = bench_game.lander.sprite;
+    for (long i = 0; i < ops; i++) {
+        sprite_position(sprite, bench_x[i & (INPUTS - 1)] & 0xff, bench_y[i & (INPUTS - 1)] & 0x7f);
+    }
+    bench_sink = sprite->attribute0;
+}
+
+void bench_sprite_move(long ops) {
+    struct Sprite* sprite = bench_game.lander.sprite;
+    for (long i = 0; i < ops; i++) {
+        sprite_move(sprite, (i & 1) ? 1 : -1, (i & 2) ? 1 : -1);
+    }
+    bench_sink = sprite->attribute1;
+}
+
+void bench_flip_sprite(long ops) {
+    struct Sprite* sprite = &sprites[entity_sprite[bench_game.thrusters[THRUST_VERTICAL]]];
+    for (long i = 0; i < ops; i++) {
+        flip_sprite(sprite, 7, 8);
+    }
+    bench_sink = sprite->attribute2;
+}
+
+void bench_ui_update(long ops) {
+    struct Lander* lander = &bench_game.lander;
+    for (long i = 0; i < ops; i++) {
+        // A thruster firing every frame changes the fuel shown every time
+        lander->fuel = lander->fuel > 1 ? bcd_decrement(lander->fuel) : 0x3000;
+        UI_update(&bench_game.ui, lander);
+    }
+    bench_sink = bench_game.ui.fuel_shown;
+}
+
+void bench_lander_update(long ops) {
+    struct Game* game = &bench_game;
+    for (long i = 0; i < ops; i++) {
+        // Start a new descent now and then so the lander stays on the map
+        if ((i & 127) == 0) {
+            landerReset(&game->lander);
+            game->yscroll = 0;
+        }
+        lander_update(&game->lander, &game->yscroll, &game->xscroll,
+                game->thrusters);
+    }
+    bench_sink = game->lander.y;
+}
+
+void bench_entity_update_all(long ops) {
+    // Every thruster firing, so each row steps its animation
+    for (int i = 0; i < THRUSTERS; i++) {
+        entity_play(bench_game.thrusters[i], &animation_thrust_side);
+    }
+    for (long i = 0; i < ops; i++) {
+        entity_update_all(bench_x[i & (INPUTS - 1)] & 0xff, bench_y[i & (INPUTS - 1)] & 0x7f);
+    }
+    bench_sink = entity_frame[0];
+}
+
+void bench_level_generate(long ops) {
+    unsigned int seed = 1;
+    for (long i = 0; i < ops; i++) {
+        // a cavern every LEVEL_CAVERN_EVERY levels, as in the game
+        level_generate(seed, level_is_cavern(i));
+        level_random(&seed);
+    }
+    bench_sink = level_pad_count;
+}
+
+void bench_update_lander_xvel(long ops) {
+    int xvel = 0, fuel = 0x3000;
+    for (long i = 0; i < ops; i++) {
+        updateLanderXvel(&xvel, (i & 1) ? LANDER_RCS : -LANDER_RCS, &fuel);
+        if (fuel == 0) {
+            fuel = 0x3000;
+        }
+    }
+    bench_sink = xvel + fuel;
+}
+
+// A benchmark and its results
+struct Bench {
+    const char* name;
+    void (*run)(long ops);
+    double median, min, max, spread; // ns per operation
+};
+
+struct Bench benches[] = {
+    { "getIndex", bench_get_index },
+    { "checkCollision", bench_check_collision },
+    { "terrain_sweep", bench_terrain_sweep },
+    { "sprite_position", bench_sprite_position },
+    { "sprite_move", bench_sprite_move },
+    { "flip_sprite", bench_flip_sprite },
+    { "UI_update", bench_ui_update },
+    { "lander_update", bench_lander_update },
+    { "entity_update_all", bench_entity_update_all },
+    { "level_generate", bench_level_generate },
+    { "updateLanderXvel.c", bench_update_lander_xvel },
+};
+
+#define BENCH_COUNT (int) (sizeof(benches) / sizeof(benches[0]))
+
+double seconds_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return x < y ? -1 : x > y;
+}
+
+// Put the game back in the state every benchmark starts from
+void bench_reset() {
+    game_init(&bench_game);
+}
+
+// Time one benchmark
+void bench_measure(struct Bench* bench, int repetitions, double target) {
+    double* times = malloc(repetitions * sizeof(double));
+
+    // Calibrate the loop length, which also warms up caches and predictors
+    bench_reset();
+    long ops = 1000;
+    for (;;) {
+        double start = seconds_now();
+        bench->run(ops);
+        if (seconds_now() - start >= target || ops >= (1L << 40)) {
+            break;
+        }
+        ops *= 2;
+    }
+
+    bench_reset();
+    bench->run(ops);
+    for (int i = 0; i < repetitions; i++) {
+        double start = seconds_now();
+        bench->run(ops);
+        times[i] = (seconds_now() - start) * 1e9 / ops;
+    }
+
+    qsort(times, repetitions, sizeof(double), compare_doubles);
+    bench->min = times[0];
+    bench->max = times[repetitions - 1];
+    bench->median = times[repetitions / 2];
+    // Median absolute deviation, which one slow repetition doesn't throw off
+    for (int i = 0; i < repetitions; i++) {
+        times[i] = fabs(times[i] - bench->median);
+    }
+    qsort(times, repetitions, sizeof(double), compare_doubles);
+    bench->spread = times[repetitions / 2];
+    free(times);
+}
+
+// Median of a benchmark in a baseline file, or 0 when it isn't there
+double baseline_median(const char* path, const char* name) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return 0;
+    }
+    char line[256], found[NAME_SIZE];
+    double median, result = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%63s %lf", found, &median) == 2 && strcmp(found, name) == 0) {
+            result = median;
+            break;
+        }
+    }
+    fclose(file);
+    return result;
+}
+
+// Change from the baseline, as text
+void print_change(const char* baseline, const char* name, double value) {
+    double before = baseline ? baseline_median(baseline, name) : 0;
+    if (before > 0) {
+        printf("  %+7.1f%%", 100.0 * (value - before) / before);
+    }
+    printf("\n");
+}
+
+// GBA cycles of the assembly routines, from the interpreter; these are exact
+// repeats, so one pass over a set of inputs is enough. Returns the number of
+// problems: built-in copies that don't match their .s file, or a stop
+int bench_interpreted(const char* baseline) {
+    struct Arm7 cpu;
+    arm7_init(&cpu, IMAGE_ROM_SIZE);
+    int problems = asm_image_load(&cpu);
+
+    const struct {
+        const char* name;
+        unsigned int address;
+        int xvel;
+    } routines[] = {
+        { "getIndex.s@iwram", IMAGE_GET_INDEX_IWRAM, 0 },
+        { "getIndex.s@rom", IMAGE_GET_INDEX_ROM, 0 },
+        { "getIndex.thumb@rom", IMAGE_GET_INDEX_THUMB, 0 },
+        { "updateLanderXvel.s@iwram", IMAGE_UPDATE_LANDER_XVEL_IWRAM, 1 },
+        { "updateLanderXvel.s@rom", IMAGE_UPDATE_LANDER_XVEL_ROM, 1 },
+    };
+
+    printf("# GBA cycles per operation (ARM7TDMI interpreter, WAITCNT 0, %s)\n",
+            asm_image_assembled ? "assembled image" : "built-in image");
+    printf("%-26s %10s\n", "#name", "cycles");
+    for (int r = 0; r < (int) (sizeof(routines) / sizeof(routines[0])); r++) {
+        unsigned long long start = cpu.cycles;
+        for (int i = 0; i < INPUTS; i++) {
+            if (routines[r].xvel) {
+                arm7_write(&cpu, IMAGE_DATA, 0, 4);
+                arm7_write(&cpu, IMAGE_DATA + 4, 0x3000, 4);
+                unsigned int args[3] = { IMAGE_DATA, (unsigned int) ((i & 1) ? LANDER_RCS : -LANDER_RCS), IMAGE_DATA + 4 };
+                arm7_call(&cpu, routines[r].address, args, 3, 1000);
+            } else {
+                unsigned int args[2] = { bench_x[i], bench_y[i] };
+                arm7_call(&cpu, routines[r].address, args, 2, 1000);
+            }
+        }
+        double cycles = (double) (cpu.cycles - start) / INPUTS;
+        printf("%-26s %10.2f", routines[r].name, cycles);
+        print_change(baseline, routines[r].name, cycles);
+    }
+    if (cpu.error) {
+        printf("# stopped: %s\n", cpu.error);
+        problems++;
+    }
+    arm7_free(&cpu);
+    return problems;
+}
+
+int main(int argc, char** argv) {
+    int repetitions = 15;
+    double target = 0.02;
+    const char* baseline = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "r:t:b:")) != -1) {
+        switch (option) {
+        case 'r': repetitions = atoi(optarg); break;
+        case 't': target = atof(optarg) / 1000; break;
+        case 'b': baseline = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-r repetitions] [-t ms] [-b baseline]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (repetitions < 1) {
+        repetitions = 1;
+    }
+
+    hal_host_init();
+    setup_background();
+    setup_sprite_image();
+
+    // The same spread of pixels for every run, some off the map
+    unsigned int seed = 1;
+    for (int i = 0; i < INPUTS; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        bench_x[i] = (int) (seed & 0x3ff) - 256;
+        bench_y[i] = (int) ((seed >> 10) & 0x3ff) - 256;
+    }
+
+    printf("# host ns per operation: median of %d repetitions of ~%.0f ms after a warm-up\n",
+            repetitions, target * 1000);
+    printf("%-26s %10s %10s %10s %10s %12s\n", "#name", "median", "min", "max", "mad", "Mops/s");
+    for (int i = 0; i < BENCH_COUNT; i++) {
+        struct Bench* bench = &benches[i];
+        bench_measure(bench, repetitions, target);
+        printf("%-26s %10.3f %10.3f %10.3f %10.3f %12.2f", bench->name, bench->median, bench->min,
+                bench->max, bench->spread, 1000.0 / bench->median);
+        print_change(baseline, bench->name, bench->median);
+    }
+    printf("\n");
+    return bench_interpreted(baseline) ? 1 : 0;
+}
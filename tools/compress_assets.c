@@ -0,0 +1,337 @@
+// Host tool that turns the png2gba / GBA Tile Editor headers into compressed
+// assets the game can decompress with the BIOS straight into VRAM.
+//
+// Tiles are converted from 8bpp to 4bpp (16 colours, palette bank 0) and
+// palettes are cut down to that one bank. Each asset is then stored as LZ77
+// or RLE in the GBA BIOS format, whichever is smaller, and maps that are one
+// tile repeated become a fill value instead. The world map is left
+// uncompressed, since the game streams it into VRAM a column or row at a time.
+// For collision, a bitset of the LunarLanderTiles tiles with any pixel drawn
+// and a 1-bit mask of every tile and sprite are written too.
+// LZ77 matches never reach back just 1 byte, since the VRAM version of the
+// BIOS call writes 16 bits at a time and could not read a byte it has not
+// written yet.
+//
+// Usage: compress_assets <output name>   (writes <name>.h and <name>.c)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LunarLanderTiles.h"
+#include "sprites.h"
+#include "world.h"
+#include "stars.h"
+#include "stars2.h"
+#include "sky.h"
+
+#include "hal.h"
+#include "transfer.h"
+
+// Kinds of asset; only maps can become fills
+enum AssetKind {
+    ASSET_PALETTE,
+    ASSET_TILES,
+    ASSET_MAP,
+    ASSET_STREAM // a map read in pieces, stored as it is
+};
+
+struct Asset {
+    const char* name;
+    enum AssetKind kind;
+    const void* data;
+    int size; // bytes
+    const char* image; // name used for the width and height macros
+    int width, height;
+};
+
+struct Asset assets[] = {
+    { "LunarLanderTiles_palette", ASSET_PALETTE, LunarLanderTiles_palette, sizeof(LunarLanderTiles_palette), NULL, 0, 0 },
+    { "LunarLanderTiles_data", ASSET_TILES, LunarLanderTiles_data, sizeof(LunarLanderTiles_data), "LunarLanderTiles", LunarLanderTiles_width, LunarLanderTiles_height },
+    { "sprites_palette", ASSET_PALETTE, sprites_palette, sizeof(sprites_palette), NULL, 0, 0 },
+    { "sprites_data", ASSET_TILES, sprites_data, sizeof(sprites_data), "sprites", sprites_width, sprites_height },
+    { "world_map", ASSET_STREAM, world, sizeof(world), "world", world_width, world_height },
+    { "stars", ASSET_MAP, stars, sizeof(stars), "stars", stars_width, stars_height },
+    { "stars2", ASSET_MAP, stars2, sizeof(stars2), "stars2", stars2_width, stars2_height },
+    { "sky", ASSET_MAP, sky, sizeof(sky), "sky", sky_width, sky_height },
+};
+
+#define NUM_ASSETS (int) (sizeof(assets) / sizeof(assets[0]))
+
+// Write the 4 byte header shared by the BIOS formats; returns bytes written
+int write_header(unsigned char* out, int type, int size) {
+    out[0] = type;
+    out[1] = size & 0xff;
+    out[2] = (size >> 8) & 0xff;
+    out[3] = (size >> 16) & 0xff;
+    return 4;
+}
+
+// LZ77 compress with a greedy longest match; returns the compressed size
+int compress_lz77(const unsigned char* in, int size, unsigned char* out) {
+    int pos = write_header(out, COMPRESSED_LZ77, size);
+    int i = 0;
+
+    while (i < size) {
+        int flag_pos = pos++;
+        out[flag_pos] = 0;
+
+        for (int bit = 0; bit < 8 && i < size; bit++) {
+            int best_length = 0, best_distance = 0;
+            // Distance 1 is left out so the data stays safe for 16-bit writes
+            for (int distance = 2; distance <= 4096 && distance <= i; distance++) {
+                int length = 0;
+                while (length < 18 && i + length < size && in[i + length] == in[i + length - distance]) {
+                    length++;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = distance;
+                }
+            }
+
+            if (best_length >= 3) {
+                out[flag_pos] |= 0x80 >> bit;
+                out[pos++] = ((best_length - 3) << 4) | ((best_distance - 1) >> 8);
+                out[pos++] = (best_distance - 1) & 0xff;
+                i += best_length;
+            } else {
+                out[pos++] = in[i++];
+            }
+        }
+    }
+    return pos;
+}
+
+// RLE compress; returns the compressed size
+int compress_rle(const unsigned char* in, int size, unsigned char* out) {
+    int pos = write_header(out, COMPRESSED_RLE, size);
+    int i = 0;
+
+    while (i < size) {
+        int run = 1;
+        while (run < 130 && i + run < size && in[i + run] == in[i]) {
+            run++;
+        }
+        if (run >= 3) {
+            out[pos++] = 0x80 | (run - 3);
+            out[pos++] = in[i];
+            i += run;
+            continue;
+        }
+
+        // Gather bytes until the next run of 3 starts
+        int start = i, length = 0;
+        while (length < 128 && i < size) {
+            if (i + 2 < size && in[i] == in[i + 1] && in[i] == in[i + 2]) {
+                break;
+            }
+            i++;
+            length++;
+        }
+        out[pos++] = length - 1;
+        memcpy(out + pos, in + start, length);
+        pos += length;
+    }
+    return pos;
+}
+
+// Pack 8bpp tiles into 4bpp, two pixels per byte with the left one in the low
+// half; returns the new size or -1 if a pixel uses a colour past 15
+int pack_4bpp(const unsigned char* in, int size, unsigned char* out) {
+    for (int i = 0; i < size; i += 2) {
+        if (in[i] > 15 || in[i + 1] > 15) {
+            return -1;
+        }
+        out[i / 2] = in[i] | (in[i + 1] << 4);
+    }
+    return size / 2;
+}
+
+// Write a bitset of 8bpp tiles with the bit of each tile set when any pixel
+// of it is drawn, so collision can skip the empty tiles without their masks
+void write_solid(FILE* header, FILE* source, const char* image, const unsigned char* data, int size) {
+    int tiles = size / 64;
+    int words = (tiles + 31) / 32;
+
+    fprintf(header, "// One bit per tile, set when any pixel of the tile is drawn\n");
+    fprintf(header, "#define %s_tiles %d\n", image, tiles);
+    fprintf(header, "extern const unsigned int %s_solid[%d];\n\n", image, words);
+
+    fprintf(source, "\nconst unsigned int %s_solid[%d] = {", image, words);
+    for (int w = 0; w < words; w++) {
+        unsigned int bits = 0;
+        for (int bit = 0; bit < 32 && w * 32 + bit < tiles; bit++) {
+            const unsigned char* tile = data + (w * 32 + bit) * 64;
+            for (int i = 0; i < 64; i++) {
+                if (tile[i]) {
+                    bits |= 1u << bit;
+                }
+            }
+        }
+        fprintf(source, "%s0x%08x,", w % 6 ? " " : "\n    ", bits);
+    }
+    fprintf(source, "\n};\n");
+}
+
+// Write the collision mask of each 8bpp tile: a byte per row, with bit n set
+// when pixel n from the left is drawn
+void write_mask(FILE* header, FILE* source, const char* image, const unsigned char* data, int size) {
+    int rows = size / 8;
+
+    fprintf(header, "// Drawn pixels of each tile, 8 rows of a byte each, bit n for pixel n from the left\n");
+    fprintf(header, "extern const unsigned char %s_mask[%d];\n\n", image, rows);
+
+    fprintf(source, "\nconst unsigned char %s_mask[%d] = {", image, rows);
+    for (int r = 0; r < rows; r++) {
+        unsigned int bits = 0;
+        for (int x = 0; x < 8; x++) {
+            if (data[r * 8 + x]) {
+                bits |= 1u << x;
+            }
+        }
+        fprintf(source, "%s0x%02x,", r % 8 ? " " : "\n    ", bits);
+    }
+    fprintf(source, "\n};\n");
+}
+
+// Whether a map is the same entry over and over
+int is_fill(const struct Asset* asset) {
+    if (asset->kind != ASSET_MAP) {
+        return 0;
+    }
+    const unsigned short* map = (const unsigned short*) asset->data;
+    for (int i = 1; i < asset->size / 2; i++) {
+        if (map[i] != map[0]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output name>\n", argv[0]);
+        return 1;
+    }
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s.h", argv[1]);
+    FILE* header = fopen(path, "w");
+    snprintf(path, sizeof(path), "%s.c", argv[1]);
+    FILE* source = fopen(path, "w");
+    if (!header || !source) {
+        perror(path);
+        return 1;
+    }
+
+    const char* base = strrchr(argv[1], '/') ? strrchr(argv[1], '/') + 1 : argv[1];
+    char guard[64];
+    int g = 0;
+    for (const char* c = base; *c && g < 60; c++) {
+        guard[g++] = (*c >= 'a' && *c <= 'z') ? *c - 32 : *c;
+    }
+    strcpy(guard + g, "_H");
+
+    fprintf(header, "/* %s.h\n * generated by tools/compress_assets from the png2gba and GBA Tile Editor headers */\n\n", base);
+    fprintf(header, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(source, "/* %s.c\n * generated by tools/compress_assets from the png2gba and GBA Tile Editor headers */\n\n", base);
+    fprintf(source, "#include \"%s.h\"\n", base);
+
+    int total_raw = 0, total_packed = 0;
+    unsigned char* lz = malloc(0x20000);
+    unsigned char* rle = malloc(0x20000);
+    unsigned char* check = malloc(0x20000);
+
+    for (int a = 0; a < NUM_ASSETS; a++) {
+        struct Asset* asset = &assets[a];
+        total_raw += asset->size;
+
+        if (asset->kind == ASSET_TILES) {
+            unsigned char* packed_4bpp = malloc(asset->size / 2);
+            asset->size = pack_4bpp(asset->data, asset->size, packed_4bpp);
+            if (asset->size < 0) {
+                fprintf(stderr, "%s: uses more than 16 colours\n", asset->name);
+                return 1;
+            }
+            asset->data = packed_4bpp;
+        } else if (asset->kind == ASSET_PALETTE) {
+            // 16 colours, 2 bytes each
+            asset->size = 32;
+        }
+
+        if (asset->image) {
+            fprintf(header, "#define %s_width %d\n", asset->image, asset->width);
+            fprintf(header, "#define %s_height %d\n", asset->image, asset->height);
+        }
+
+        if (is_fill(asset)) {
+            unsigned short entry = ((const unsigned short*) asset->data)[0];
+            fprintf(header, "// %d byte map of one repeated entry\n", asset->size);
+            fprintf(header, "#define %s_fill 0x%04x\n\n", asset->name, entry);
+            fprintf(stderr, "%-26s %5d -> fill\n", asset->name, asset->size);
+            continue;
+        }
+
+        if (asset->kind == ASSET_STREAM) {
+            const unsigned short* map = (const unsigned short*) asset->data;
+            total_packed += asset->size;
+
+            fprintf(header, "// Uncompressed, %d bytes\n", asset->size);
+            fprintf(header, "extern const unsigned short %s[%d];\n\n", asset->name, asset->size / 2);
+
+            fprintf(source, "\nconst unsigned short %s[%d] = {", asset->name, asset->size / 2);
+            for (int i = 0; i < asset->size / 2; i++) {
+                fprintf(source, "%s0x%04x,", i % 12 ? " " : "\n    ", map[i]);
+            }
+            fprintf(source, "\n};\n");
+
+            fprintf(stderr, "%-26s %5d -> %5d (raw)\n", asset->name, asset->size, asset->size);
+            continue;
+        }
+
+        int lz_size = compress_lz77(asset->data, asset->size, lz);
+        int rle_size = compress_rle(asset->data, asset->size, rle);
+        unsigned char* packed = lz_size <= rle_size ? lz : rle;
+        int packed_size = lz_size <= rle_size ? lz_size : rle_size;
+
+        // Make sure the data comes back exactly as it went in
+        memset(check, 0xcd, asset->size);
+        transfer_decompress(check, packed);
+        if (memcmp(check, asset->data, asset->size) != 0) {
+            fprintf(stderr, "%s: round trip failed\n", asset->name);
+            return 1;
+        }
+
+        // Pad to whole words so the next asset stays aligned
+        while (packed_size & 3) {
+            packed[packed_size++] = 0;
+        }
+        total_packed += packed_size;
+
+        fprintf(header, "// %s, %d bytes compressed to %d\n", packed == lz ? "LZ77" : "RLE", asset->size, packed_size);
+        fprintf(header, "#define %s_size %d\n", asset->name, asset->size);
+        fprintf(header, "extern const unsigned int %s_compressed[%d];\n\n", asset->name, packed_size / 4);
+
+        fprintf(source, "\nconst unsigned int %s_compressed[%d] = {", asset->name, packed_size / 4);
+        for (int i = 0; i < packed_size / 4; i++) {
+            unsigned int word = packed[i * 4] | (packed[i * 4 + 1] << 8) | (packed[i * 4 + 2] << 16) | ((unsigned int) packed[i * 4 + 3] << 24);
+            fprintf(source, "%s0x%08x,", i % 6 ? " " : "\n    ", word);
+        }
+        fprintf(source, "\n};\n");
+
+        fprintf(stderr, "%-26s %5d -> %5d (%s)\n", asset->name, asset->size, packed_size, packed == lz ? "LZ77" : "RLE");
+    }
+
+    // Which pixels of the ground tiles and the sprites are solid, for collision
+    write_solid(header, source, "LunarLanderTiles", LunarLanderTiles_data, sizeof(LunarLanderTiles_data));
+    write_mask(header, source, "LunarLanderTiles", LunarLanderTiles_data, sizeof(LunarLanderTiles_data));
+    write_mask(header, source, "sprites", sprites_data, sizeof(sprites_data));
+
+    fprintf(header, "#endif\n");
+    fprintf(stderr, "total %d -> %d bytes\n", total_raw, total_packed);
+
+    fclose(header);
+    fclose(source);
+    return 0;
+}
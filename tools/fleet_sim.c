@@ -0,0 +1,453 @@
+// Host tool for tuning the flight model: flies a large fleet of independent
+// landers over the game's terrain and reports how they land.
+//
+// Each lander is flown with the game's own code, lander_step (game.c): the
+// same sweep, collision test and landing rule as lander_update and the same
+// thrust as game_update, from the game's start position until it touches down
+// or runs out of time, with its buttons picked by an input policy.
+// replay_runner checks that lander_step and game_update fly a lander the same
+// way. The fleet flies over the world map and the levels generated after it,
+// with the same seeds as the game, its landers shared out evenly between
+// them. Each lander is stepped on its own, through the scalar game code, so
+// the fleet is split into blocks that are shared out between worker threads,
+// which keep their own statistics, so the run scales with the number of cores.
+//
+// Usage: fleet_sim [-n landers] [-j threads] [-f frames] [-p random|autopilot]
+//                  [-s seed] [-x start_x] [-l levels]
+//                  [gravity,thrust,rcs,max_xvel,max_yvel ...]
+//
+// Every parameter set given is flown with the same policy and seed, by
+// setting flight_model (physics.h); with none the constants from physics.h
+// are used.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "hal.h"
+#include "bcd.h"
+#include "game.h"
+#include "physics.h"
+#include "terrain.h"
+#include "level.h"
+#include "assets.h"
+
+// Landers a worker thread takes at a time
+#define BLOCK 1024
+
+// Fuel at the start, as a count rather than packed BCD
+#define LANDER_FUEL_UNITS bcd_value(LANDER_FUEL)
+
+// Range kept by the histograms for each statistic
+#define FUEL_BINS (LANDER_FUEL_UNITS + 1)
+#define VEL_MIN -4096
+#define VEL_BINS 12288
+#define FRAME_BINS 65536
+
+// How a lander's flight ended
+enum Outcome {
+    FLYING,
+    LANDED,
+    CRASHED,
+    TIMED_OUT
+};
+
+enum Policy {
+    POLICY_RANDOM,
+    POLICY_AUTOPILOT
+};
+
+// Distribution of a statistic, one bin per unit from min
+struct Histogram {
+    int min;
+    int bins;
+    long* counts;
+    long total;
+    double sum;
+};
+
+// Results of one parameter set, one copy per thread until the end
+struct Stats {
+    long outcomes[4];
+    struct Histogram fuel; // fuel left after a landing
+    struct Histogram yvel; // vertical velocity at touchdown
+    struct Histogram xvel; // horizontal velocity at touchdown
+    struct Histogram frames; // frames until touchdown
+    long lander_frames;
+};
+
+// A block of landers, with the scroll of the game each one is in
+struct Fleet {
+    struct Lander lander[BLOCK];
+    int xscroll[BLOCK], yscroll[BLOCK];
+    unsigned short keys[BLOCK]; // buttons read last frame
+    unsigned short held[BLOCK]; // policy state
+    unsigned int seed[BLOCK];
+    int hold[BLOCK];
+    int gain[BLOCK];
+};
+
+// Settings shared by all the threads
+struct Run {
+    struct FlightModel model;
+    enum Policy policy;
+    long landers;
+    int levels; // the world map and the levels generated after it
+    int max_frames;
+    int start_x; // -1 for a random column per lander
+    unsigned int seed;
+    long first; // number of the first lander on the level being flown
+    long count; // landers on the level being flown
+    long next_block; // next block of them to fly, taken under the lock
+    pthread_mutex_t lock;
+};
+
+// Work of one thread
+struct Worker {
+    pthread_t thread;
+    struct Run* run;
+    struct Stats stats;
+};
+
+void histogram_init(struct Histogram* histogram, int min, int bins) {
+    histogram->min = min;
+    histogram->bins = bins;
+    histogram->counts = calloc(bins, sizeof(long));
+    histogram->total = 0;
+    histogram->sum = 0;
+}
+
+// Count a value, clamped into the range of the histogram
+void histogram_add(struct Histogram* histogram, int value) {
+    int bin = value - histogram->min;
+    if (bin < 0) {
+        bin = 0;
+    } else if (bin >= histogram->bins) {
+        bin = histogram->bins - 1;
+    }
+    histogram->counts[bin]++;
+    histogram->total++;
+    histogram->sum += value;
+}
+
+void histogram_merge(struct Histogram* into, const struct Histogram* from) {
+    for (int i = 0; i < into->bins; i++) {
+        into->counts[i] += from->counts[i];
+    }
+    into->total += from->total;
+    into->sum += from->sum;
+}
+
+// Value below which the given fraction of the counts fall
+int histogram_percentile(const struct Histogram* histogram, double fraction) {
+    long target = (long) (fraction * (histogram->total - 1));
+    long seen = 0;
+    for (int i = 0; i < histogram->bins; i++) {
+        seen += histogram->counts[i];
+        if (seen > target) {
+            return histogram->min + i;
+        }
+    }
+    return histogram->min + histogram->bins - 1;
+}
+
+void histogram_print(const char* label, const struct Histogram* histogram) {
+    if (histogram->total == 0) {
+        printf("  %-18s none\n", label);
+        return;
+    }
+    printf("  %-18s min %6d  p10 %6d  p50 %6d  p90 %6d  max %6d  mean %8.1f\n", label,
+            histogram_percentile(histogram, 0), histogram_percentile(histogram, 0.1),
+            histogram_percentile(histogram, 0.5), histogram_percentile(histogram, 0.9),
+            histogram_percentile(histogram, 1), histogram->sum / histogram->total);
+}
+
+void stats_init(struct Stats* stats) {
+    memset(stats->outcomes, 0, sizeof(stats->outcomes));
+    histogram_init(&stats->fuel, 0, FUEL_BINS);
+    histogram_init(&stats->yvel, VEL_MIN, VEL_BINS);
+    histogram_init(&stats->xvel, VEL_MIN, VEL_BINS);
+    histogram_init(&stats->frames, 0, FRAME_BINS);
+    stats->lander_frames = 0;
+}
+
+void stats_merge(struct Stats* into, const struct Stats* from) {
+    for (int i = 0; i < 4; i++) {
+        into->outcomes[i] += from->outcomes[i];
+    }
+    histogram_merge(&into->fuel, &from->fuel);
+    histogram_merge(&into->yvel, &from->yvel);
+    histogram_merge(&into->xvel, &from->xvel);
+    histogram_merge(&into->frames, &from->frames);
+    into->lander_frames += from->lander_frames;
+}
+
+unsigned int xorshift(unsigned int s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+// Buttons for the next frame of one lander
+unsigned short policy_keys(struct Fleet* fleet, int i, enum Policy policy) {
+    struct Lander* lander = &fleet->lander[i];
+    if (policy == POLICY_RANDOM) {
+        // Hold a random button combination for a random number of frames
+        static const unsigned short choices[] = {
+            0, BUTTON_A, BUTTON_A, BUTTON_A | BUTTON_LEFT, BUTTON_A | BUTTON_RIGHT, BUTTON_LEFT, BUTTON_RIGHT, 0,
+            0, BUTTON_A, BUTTON_A, BUTTON_A | BUTTON_L, BUTTON_A | BUTTON_R, BUTTON_L, BUTTON_R, 0
+        };
+        if (fleet->hold[i] == 0) {
+            fleet->seed[i] = xorshift(fleet->seed[i]);
+            fleet->hold[i] = 1 + ((fleet->seed[i] >> 8) & 63);
+            fleet->held[i] = choices[fleet->seed[i] & 15];
+        }
+        fleet->hold[i]--;
+        return fleet->held[i];
+    }
+
+    // Autopilot: hold the descent rate it could still brake from before the
+    // ground, plus half the landing limit; gain is the percentage of the full
+    // braking each pilot counts on, so some brake too late
+    int left = fleet->xscroll[i] + lander->x;
+    int bottom = fleet->yscroll[i] + lander->y + lander->height - 1;
+    int altitude = terrain_altitude(left, left + lander->width - 1, bottom);
+    int braking = flight_model.thrust - flight_model.gravity;
+    int target = flight_model.max_yvel / 2;
+    if (altitude > 0 && braking > 0) {
+        target += (int) (sqrt(2.0 * braking * 256 * altitude) * fleet->gain[i] / 100);
+    }
+
+    unsigned short keys = 0;
+    if (lander->yvel + flight_model.gravity > target) {
+        keys |= BUTTON_A;
+    }
+    // Keep the drift inside the landing limit
+    if (lander->xvel < 0) {
+        keys |= BUTTON_RIGHT;
+    } else if (lander->xvel > flight_model.max_xvel / 2) {
+        keys |= BUTTON_LEFT;
+    }
+    // and the lander upright
+    if (lander->angle > 0) {
+        keys |= BUTTON_L;
+    } else if (lander->angle < 0) {
+        keys |= BUTTON_R;
+    }
+    return keys;
+}
+
+// Put a block of landers at the start of the game, the way game_init does
+void fleet_start(struct Fleet* fleet, int count, long first, const struct Run* run) {
+    for (int i = 0; i < count; i++) {
+        unsigned int seed = xorshift(run->seed ^ (unsigned int) ((first + i) * 0x9e3779b9));
+        if (seed == 0) {
+            seed = 1;
+        }
+        fleet->seed[i] = seed;
+        fleet->hold[i] = 0;
+        fleet->gain[i] = 50 + (seed >> 24) % 60;
+        lander_start(&fleet->lander[i]);
+        fleet->xscroll[i] = run->start_x >= 0 ? run->start_x : (int) ((seed >> 4) & (terrain_width - 1));
+        fleet->yscroll[i] = fleet->lander[i].y - 20;
+        fleet->keys[i] = 0;
+        fleet->held[i] = 0;
+    }
+}
+
+// Fly one block to the end and add its landers to the statistics
+void fly_block(struct Fleet* fleet, int count, const struct Run* run, struct Stats* stats) {
+    int flying = count;
+    int frame;
+    for (frame = 1; frame <= run->max_frames && flying > 0; frame++) {
+        for (int i = 0; i < count; i++) {
+            struct Lander* lander = &fleet->lander[i];
+            if (lander->landed) {
+                continue;
+            }
+            // Fly with the buttons read last frame, as game_update does
+            int touchdown = lander_step(lander, &fleet->yscroll[i], &fleet->xscroll[i], fleet->keys[i]);
+            if (touchdown) {
+                stats->outcomes[touchdown == 2 ? LANDED : CRASHED]++;
+                if (touchdown == 2) {
+                    histogram_add(&stats->fuel, bcd_value(lander->fuel));
+                }
+                histogram_add(&stats->yvel, lander->yvel);
+                histogram_add(&stats->xvel, lander->xvel);
+                histogram_add(&stats->frames, frame);
+                flying--;
+                continue;
+            }
+            // Buttons for the next frame
+            fleet->keys[i] = policy_keys(fleet, i, run->policy);
+        }
+        stats->lander_frames += flying;
+    }
+
+    stats->outcomes[TIMED_OUT] += flying;
+}
+
+void* worker_main(void* arg) {
+    struct Worker* worker = arg;
+    struct Run* run = worker->run;
+    struct Fleet* fleet = malloc(sizeof(struct Fleet));
+
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        long block = run->next_block++;
+        pthread_mutex_unlock(&run->lock);
+
+        long first = block * BLOCK;
+        if (first >= run->count) {
+            break;
+        }
+        int count = run->count - first < BLOCK ? (int) (run->count - first) : BLOCK;
+        fleet_start(fleet, count, run->first + first, run);
+        fly_block(fleet, count, run, &worker->stats);
+    }
+
+    free(fleet);
+    return NULL;
+}
+
+void stats_free(struct Stats* stats) {
+    free(stats->fuel.counts);
+    free(stats->yvel.counts);
+    free(stats->xvel.counts);
+    free(stats->frames.counts);
+}
+
+// Fly the landers given to the level loaded in the terrain, adding them to stats
+double fly_level(struct Run* run, int threads, struct Stats* stats) {
+    struct Worker* workers = calloc(threads, sizeof(struct Worker));
+    run->next_block = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < threads; t++) {
+        workers[t].run = run;
+        stats_init(&workers[t].stats);
+        pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (int t = 0; t < threads; t++) {
+        stats_merge(stats, &workers[t].stats);
+        stats_free(&workers[t].stats);
+    }
+    free(workers);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Fly the whole fleet with one parameter set over each level and print the results
+void run_params(struct Run* run, int threads) {
+    flight_model = run->model;
+    const struct FlightModel* p = &flight_model;
+    printf("gravity=%d thrust=%d rcs=%d max_xvel=%d max_yvel=%d\n",
+            p->gravity, p->thrust, p->rcs, p->max_xvel, p->max_yvel);
+
+    struct Stats total;
+    stats_init(&total);
+    double seconds = 0;
+    // The world map, then the levels game_next_level generates after it
+    unsigned int level_seed = 1;
+    for (int level = 1; level <= run->levels; level++) {
+        if (level == 1) {
+            terrain_init(world_map, world_width, world_height);
+        } else {
+            level_generate(level_seed, level_is_cavern(level));
+            level_random(&level_seed);
+        }
+        run->first = run->landers * (level - 1) / run->levels;
+        run->count = run->landers * level / run->levels - run->first;
+
+        struct Stats stats;
+        stats_init(&stats);
+        seconds += fly_level(run, threads, &stats);
+        printf("  level %d %-8s %ld landers: %.2f%% landed\n", level,
+                level == 1 ? "(world)" : level_is_cavern(level) ? "(cavern)" : "", run->count,
+                run->count ? 100.0 * stats.outcomes[LANDED] / run->count : 0.0);
+        stats_merge(&total, &stats);
+        stats_free(&stats);
+    }
+
+    printf("  %ld landers: %.2f%% landed, %.2f%% crashed, %.2f%% timed out\n", run->landers,
+            100.0 * total.outcomes[LANDED] / run->landers,
+            100.0 * total.outcomes[CRASHED] / run->landers,
+            100.0 * total.outcomes[TIMED_OUT] / run->landers);
+    histogram_print("fuel left", &total.fuel);
+    histogram_print("touchdown yvel", &total.yvel);
+    histogram_print("touchdown xvel", &total.xvel);
+    histogram_print("frames", &total.frames);
+    printf("  %.3f s, %.0f lander frames/s\n", seconds,
+            seconds > 0 ? total.lander_frames / seconds : 0.0);
+    stats_free(&total);
+}
+
+int main(int argc, char** argv) {
+    struct Run run;
+    run.policy = POLICY_AUTOPILOT;
+    run.landers = 1000000;
+    run.max_frames = 3600;
+    run.start_x = -1;
+    run.levels = 4;
+    run.seed = 1;
+    pthread_mutex_init(&run.lock, NULL);
+    int threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    int option;
+    while ((option = getopt(argc, argv, "n:j:f:p:s:x:l:")) != -1) {
+        switch (option) {
+        case 'n': run.landers = atol(optarg); break;
+        case 'j': threads = atoi(optarg); break;
+        case 'f': run.max_frames = atoi(optarg); break;
+        case 's': run.seed = (unsigned int) strtoul(optarg, NULL, 0); break;
+        case 'x': run.start_x = atoi(optarg); break;
+        case 'l': run.levels = atoi(optarg); break;
+        case 'p':
+            if (strcmp(optarg, "random") == 0) {
+                run.policy = POLICY_RANDOM;
+            } else if (strcmp(optarg, "autopilot") == 0) {
+                run.policy = POLICY_AUTOPILOT;
+            } else {
+                fprintf(stderr, "unknown policy %s\n", optarg);
+                return 2;
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n landers] [-j threads] [-f frames] [-p random|autopilot]\n"
+                    "       [-s seed] [-x start_x] [-l levels] [gravity,thrust,rcs,max_xvel,max_yvel ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (run.levels < 1) {
+        run.levels = 1;
+    }
+
+    printf("policy %s, %d threads, up to %d frames per lander, %d levels\n",
+            run.policy == POLICY_RANDOM ? "random" : "autopilot", threads, run.max_frames, run.levels);
+
+    struct FlightModel defaults = flight_model;
+    if (optind == argc) {
+        run.model = defaults;
+        run_params(&run, threads);
+    }
+    for (int i = optind; i < argc; i++) {
+        run.model = defaults;
+        sscanf(argv[i], "%d,%d,%d,%d,%d", &run.model.gravity, &run.model.thrust,
+                &run.model.rcs, &run.model.max_xvel, &run.model.max_yvel);
+        run_params(&run, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+// Host regression runner for recorded input logs.
+//
+// A suite file holds many sessions: the input log of each one plus the
+// lander state it ended in. "record" plays scripted random pilots through the
+// game while the input recorder logs them, and "check" replays every log from
+// game_init through the same frame loop and compares the final state, so a
+// physics change that alters any landing shows up in seconds. "check" also
+// flies each log up to the lander's first touchdown with lander_step, the way
+// fleet_sim flies its landers, and checks that it ends in the same state as
+// the game did with game_update.
+//
+// Usage: replay_runner record <suite> [sessions] [frames] [seed]
+//        replay_runner check <suite>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game.h"
+#include "frame.h"
+#include "input.h"
+#include "replay.h"
+
+// Start of every session in a suite file
+#define SESSION_MAGIC 0x32524c4c // "LLR2", since the lander's angle was added
+
+// Most runs a session may record
+#define MAX_RUNS 65536
+
+// Lander state at the end of a session
+struct ReplayResult {
+    int x, y;
+    int xvel, yvel;
+    int fuel, score;
+    int xscroll, yscroll;
+    int angle;
+};
+
+// Header of a session, followed by run_count runs
+struct SessionHeader {
+    unsigned int magic;
+    unsigned int frames;
+    unsigned int run_count;
+    struct ReplayResult expected;
+};
+
+// Scripted pilot for recording: holds a random button combination for a
+// random number of frames, like a player would
+struct Pilot {
+    unsigned int seed;
+    unsigned short held;
+    int hold;
+};
+
+unsigned short pilot_buttons(struct Pilot* pilot) {
+    static const unsigned short choices[] = {
+        0, BUTTON_A, BUTTON_A, BUTTON_A | BUTTON_LEFT, BUTTON_A | BUTTON_RIGHT, BUTTON_LEFT, BUTTON_RIGHT, 0,
+        0, BUTTON_A, BUTTON_A, BUTTON_A | BUTTON_L, BUTTON_A | BUTTON_R, BUTTON_L, BUTTON_R, 0
+    };
+
+    if (pilot->hold == 0) {
+        unsigned int s = pilot->seed;
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        pilot->seed = s;
+        pilot->held = choices[s & 15];
+        pilot->hold = 1 + ((s >> 8) & 63);
+    }
+    pilot->hold--;
+    return pilot->held;
+}
+
+// Step the game the way main() does; buttons come from the pilot when there
+// is one and from the log being played otherwise
+void run_frames(struct Game* game, unsigned int frames, struct Pilot* pilot) {
+    for (unsigned int i = 0; i < frames; i++) {
+        game_update(game);
+        frame_wait();
+        if (pilot) {
+            hal_host_set_buttons(pilot_buttons(pilot));
+        }
+        input_poll();
+        game_draw(game);
+    }
+}
+
+// Copy the parts of a lander's state a session is checked on
+void lander_result(const struct Lander* lander, int xscroll, int yscroll, struct ReplayResult* result) {
+    result->x = lander->x;
+    result->y = lander->y;
+    result->xvel = lander->xvel;
+    result->yvel = lander->yvel;
+    result->fuel = lander->fuel;
+    result->score = lander->score;
+    result->xscroll = xscroll;
+    result->yscroll = yscroll;
+    result->angle = lander->angle;
+}
+
+// Copy the parts of the game state a session is checked on
+void get_result(struct Game* game, struct ReplayResult* result) {
+    lander_result(&game->lander, game->xscroll, game->yscroll, result);
+}
+
+// Print a result on one line
+void print_result(const char* label, const struct ReplayResult* r) {
+    printf("  %s: x=%d y=%d xvel=%d yvel=%d fuel=%x score=%x scroll=%d,%d angle=%d\n",
+            label, r->x, r->y, r->xvel, r->yvel, r->fuel, r->score, r->xscroll, r->yscroll, r->angle);
+}
+
+int record(const char* path, int sessions, unsigned int frames, unsigned int seed) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    struct InputRun* runs = malloc(MAX_RUNS * sizeof(struct InputRun));
+    struct Game game;
+    long total_runs = 0;
+
+    for (int i = 0; i < sessions; i++) {
+        struct Pilot pilot = { seed + i * 0x9e3779b9, 0, 0 };
+        if (pilot.seed == 0) {
+            pilot.seed = 1;
+        }
+
+        hal_host_set_buttons(0);
+        game_init(&game);
+        frame_init();
+        replay_record(runs, MAX_RUNS);
+        run_frames(&game, frames, &pilot);
+
+        struct SessionHeader header;
+        header.magic = SESSION_MAGIC;
+        header.frames = frames;
+        header.run_count = replay_stop();
+        get_result(&game, &header.expected);
+        if (replay_overflow) {
+            fprintf(stderr, "%s: session %d: input log full after %d runs\n", path, i, header.run_count);
+            fclose(file);
+            free(runs);
+            return 1;
+        }
+
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(runs, sizeof(struct InputRun), header.run_count, file);
+        total_runs += header.run_count;
+    }
+
+    fclose(file);
+    printf("recorded %d sessions of %u frames (%ld input runs, %ld bytes of logs)\n",
+            sessions, frames, total_runs, total_runs * (long) sizeof(struct InputRun));
+    return 0;
+}
+
+// Play a log through the game up to the lander's first touchdown, then fly a
+// lander from the start with lander_step on the buttons game_update saw each
+// frame, as fleet_sim does; returns 0 when the two end differently
+int check_lander_step(struct Game* game, const struct InputRun* runs, int run_count, unsigned int frames,
+        unsigned short* keys, int session) {
+    game_init(game);
+    frame_init();
+    replay_play(runs, run_count);
+    unsigned int played = 0;
+    while (played < frames && !game->lander.landed) {
+        keys[played++] = input_keys;
+        run_frames(game, 1, NULL);
+    }
+    replay_stop();
+
+    // A lander started the way game_init starts the game's, on the same terrain
+    struct Lander lander;
+    lander_start(&lander);
+    int xscroll = lander.x;
+    int yscroll = lander.y - 20;
+    for (unsigned int i = 0; i < played; i++) {
+        lander_step(&lander, &yscroll, &xscroll, keys[i]);
+    }
+
+    struct ReplayResult expected, result;
+    get_result(game, &expected);
+    lander_result(&lander, xscroll, yscroll, &result);
+    if (memcmp(&result, &expected, sizeof(result)) != 0) {
+        printf("session %d: lander_step differs from game_update after %u frames\n", session, played);
+        print_result("game    ", &expected);
+        print_result("step    ", &result);
+        return 0;
+    }
+    return 1;
+}
+
+int check(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    struct InputRun* runs = malloc(MAX_RUNS * sizeof(struct InputRun));
+    struct Game game;
+    struct SessionHeader header;
+    unsigned short* keys = NULL;
+    unsigned int keys_size = 0;
+    int sessions = 0, failures = 0;
+    long frames = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (fread(&header, sizeof(header), 1, file) == 1) {
+        if (header.magic != SESSION_MAGIC || header.run_count > MAX_RUNS
+                || fread(runs, sizeof(struct InputRun), header.run_count, file) != header.run_count) {
+            fprintf(stderr, "%s: session %d is damaged\n", path, sessions);
+            return 1;
+        }
+
+        game_init(&game);
+        frame_init();
+        replay_play(runs, header.run_count);
+        run_frames(&game, header.frames, NULL);
+        replay_stop();
+
+        struct ReplayResult result;
+        get_result(&game, &result);
+        if (memcmp(&result, &header.expected, sizeof(result)) != 0) {
+            printf("session %d differs after %u frames\n", sessions, header.frames);
+            print_result("expected", &header.expected);
+            print_result("got     ", &result);
+            failures++;
+        }
+
+        if (header.frames > keys_size) {
+            keys_size = header.frames;
+            keys = realloc(keys, keys_size * sizeof(unsigned short));
+        }
+        if (!check_lander_step(&game, runs, header.run_count, header.frames, keys, sessions)) {
+            failures++;
+        }
+
+        sessions++;
+        frames += header.frames;
+    }
+    fclose(file);
+    free(keys);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%d sessions, %ld frames, %d differ (%.3f s, %.0f frames/s)\n",
+            sessions, frames, failures, seconds, seconds > 0 ? frames / seconds : 0.0);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s record <suite> [sessions] [frames] [seed]\n", argv[0]);
+        fprintf(stderr, "       %s check <suite>\n", argv[0]);
+        return 2;
+    }
+
+    hal_host_init();
+    setup_background();
+    setup_sprite_image();
+
+    if (strcmp(argv[1], "record") == 0) {
+        int sessions = argc > 3 ? atoi(argv[3]) : 1000;
+        unsigned int frames = argc > 4 ? (unsigned int) atol(argv[4]) : 3600;
+        unsigned int seed = argc > 5 ? (unsigned int) strtoul(argv[5], NULL, 0) : 1;
+        return record(argv[2], sessions, frames, seed);
+    }
+    if (strcmp(argv[1], "check") == 0) {
+        return check(argv[2]);
+    }
+    fprintf(stderr, "unknown command %s\n", argv[1]);
+    return 2;
+}
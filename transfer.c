@@ -0,0 +1,46 @@
+#include "hal.h"
+#include "transfer.h"
+
+// Value a fill reads over and over, DMA needs it to be in memory
+volatile unsigned int transfer_fill_value;
+
+// Whether an address or size is a multiple of n bytes
+#define aligned(value, n) ((((unsigned long) (value)) & ((n) - 1)) == 0)
+
+// Copy bytes with DMA 3
+void transfer_dma(volatile void* dest, const void* source, int bytes) {
+    if (aligned(dest, 4) && aligned(source, 4) && aligned(bytes, 4)) {
+        hal_dma3(dest, source, (bytes / 4) | DMA_32 | DMA_ENABLE);
+    } else {
+        hal_dma3(dest, source, (bytes / 2) | DMA_16 | DMA_ENABLE);
+    }
+}
+
+// Fill bytes with a repeated 32-bit value using fixed-source DMA 3
+void transfer_fill(volatile void* dest, unsigned int value, int bytes) {
+    transfer_fill_value = value;
+    if (aligned(dest, 4) && aligned(bytes, 4)) {
+        hal_dma3(dest, &transfer_fill_value, (bytes / 4) | DMA_32 | DMA_SOURCE_FIXED | DMA_ENABLE);
+    } else {
+        hal_dma3(dest, &transfer_fill_value, (bytes / 2) | DMA_16 | DMA_SOURCE_FIXED | DMA_ENABLE);
+    }
+}
+
+// Copy bytes with the BIOS CpuFastSet, which moves 8 words per loop
+void transfer_fast(volatile void* dest, const void* source, int bytes) {
+    // CpuFastSet always moves whole blocks of 32 bytes
+    if (aligned(dest, 4) && aligned(source, 4) && aligned(bytes, 32)) {
+        hal_cpu_fast_set(source, dest, bytes / 4);
+    } else {
+        transfer_dma(dest, source, bytes);
+    }
+}
+
+// Decompress LZ77 or RLE data straight from ROM into VRAM or palette RAM
+void transfer_decompress(volatile void* dest, const void* source) {
+    if ((*(const unsigned char*) source & 0xf0) == COMPRESSED_RLE) {
+        hal_rl_uncomp_vram(source, dest);
+    } else {
+        hal_lz77_uncomp_vram(source, dest);
+    }
+}
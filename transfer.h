@@ -0,0 +1,23 @@
+#ifndef TRANSFER_H
+#define TRANSFER_H
+
+// Bulk copies and fills into VRAM, palette RAM and OAM. Word aligned
+// transfers take the fast 32-bit path; anything else falls back to 16 bits.
+
+// Copy bytes with DMA 3
+void transfer_dma(volatile void* dest, const void* source, int bytes);
+
+// Fill bytes with a repeated 32-bit value using fixed-source DMA 3
+void transfer_fill(volatile void* dest, unsigned int value, int bytes);
+
+// Copy bytes with the BIOS CpuFastSet, which moves 8 words per loop
+void transfer_fast(volatile void* dest, const void* source, int bytes);
+
+// Compression types stored in the first byte of GBA BIOS compressed data
+#define COMPRESSED_LZ77 0x10
+#define COMPRESSED_RLE 0x30
+
+// Decompress LZ77 or RLE data straight from ROM into VRAM or palette RAM
+void transfer_decompress(volatile void* dest, const void* source);
+
+#endif
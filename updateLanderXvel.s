@@ -1,21 +1,34 @@
 @ updateLanderXvel.s
 
-.global updateLanderXvel
+@ put through the C preprocessor for the 8.8 limits (fixed.h)
+#include "fixed.h"
+
+    .text
+    .arm
+    .align 2
+    .global updateLanderXvel
+    .type updateLanderXvel, %function
 updateLanderXvel:
+@ add the side thrust, negative to the left
     ldr r3, [r0]
-    cmp r1, #1
-    beq .right
-@ move left
-    sub r3, r3, #30
-    b .return
-@ move right
-.right:
-    add r3, r3, #30
-.return:
+    add r3, r3, r1
+@ clamp to 0x7fff and -0x8000, as fixed8_add_sat does
+    cmp r3, #(FIXED8_MAX + 1)
+    movge r3, #0x7f00
+    orrge r3, r3, #0xff
+    cmn r3, #-FIXED8_MIN
+    mvnlt r3, #0x7f00
+    biclt r3, r3, #0xff
     str r3, [r0]
-@ decrement fuel
+@ decrement fuel (packed BCD, one digit per 4 bits)
     ldr r3, [r2]
-    sub r3, r3, #1
-    str r3, [r2]
-@done
-    mov pc, lr
+    sub r1, r3, #1
+@ every digit that borrowed went from 0 to 0xf, take 6 off each to make it 9
+    eor r3, r3, r1
+    ldr r0, =0x01111111
+    and r3, r0, r3, lsr #4
+    add r3, r3, r3, lsl #1
+    sub r1, r1, r3, lsl #1
+    str r1, [r2]
+@done, bx returns to Thumb callers as well as ARM ones
+    bx lr